@@ -1,9 +1,18 @@
 
 #ifndef TEST_CASES_MATRIX_HPP
 #define TEST_CASES_MATRIX_HPP
+#include <fstream>
 #include <iostream>
+#include <numbers>
 #include <string>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
+#include "GenerateMatrix.hpp"
 #include "Matrix.hpp"
 #include "ReadMatrix.hpp"
 #include "Utilities.hpp"
@@ -19,6 +28,94 @@ void _print_test_case() {
   std::cout << "Test case for ordering(0 = row, 1 = col)" << Store << "\n";
 }
 
+// resident set size of the process in bytes, field is VmRSS (current) or
+// VmHWM (peak), 0 if /proc is not available
+std::size_t _rss_bytes(const std::string& field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind(field + ":", 0) == 0) return std::stoul(line.substr(field.size() + 1)) * 1024;
+  }
+  return 0;
+}
+
+// give the freed heap pages back to the system and reset the peak resident
+// set size to the current one (Linux only)
+void _reset_peak_rss() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
+
+// block-Jacobi setup on a compressed matrix: extract the diagonal blocks of
+// size block_size either element by element or with submatrix()
+void _block_jacobi_setup(const Matrix<T, Store>& matrix, std::size_t block_size) {
+  Timings::Chrono timer;
+  const std::size_t n = std::max(matrix.rows(), matrix.cols());
+  const std::size_t num_blocks = (n + block_size - 1) / block_size;
+
+  // old path: dense blocks filled through operator()
+  timer.start();
+  std::vector<T> dense_blocks(num_blocks * block_size * block_size, 0);
+  for (std::size_t b = 0; b < num_blocks; ++b) {
+    const std::size_t first = b * block_size;
+    const std::size_t size = std::min(block_size, n - first);
+    for (std::size_t i = 0; i < size; ++i)
+      for (std::size_t j = 0; j < size; ++j)
+        dense_blocks[(b * block_size + i) * block_size + j] = matrix(first + i, first + j);
+  }
+  timer.stop();
+  double time_lookup = timer.wallTime();
+
+  // new path: compressed diagonal blocks A(I_b, I_b)
+  timer.start();
+  std::vector<Matrix<T, Store>> sparse_blocks;
+  sparse_blocks.reserve(num_blocks);
+  std::size_t block_nnz = 0;
+  for (std::size_t b = 0; b < num_blocks; ++b) {
+    std::vector<std::size_t> indices(std::min(block_size, n - b * block_size));
+    std::iota(indices.begin(), indices.end(), b * block_size);
+    sparse_blocks.push_back(matrix.submatrix(indices, indices));
+    block_nnz += sparse_blocks.back().nnz();
+  }
+  timer.stop();
+  double time_submatrix = timer.wallTime();
+
+  // one arbitrary (strided, unsorted) index set to check against operator()
+  std::vector<std::size_t> rows_sel, cols_sel;
+  for (std::size_t i = n; i-- > 0;)
+    if (i % 3 == 0) rows_sel.push_back(i);
+  for (std::size_t i = 0; i < n; i += 2) cols_sel.push_back(i);
+  const auto sub = matrix.submatrix(rows_sel, cols_sel);
+  T max_err = 0;
+  for (std::size_t i = 0; i < std::min<std::size_t>(rows_sel.size(), 200); ++i)
+    for (std::size_t j = 0; j < std::min<std::size_t>(cols_sel.size(), 200); ++j)
+      max_err = std::max(max_err, std::abs(sub(i, j) - matrix(rows_sel[i], cols_sel[j])));
+
+  std::cout << "Block-Jacobi setup with " << num_blocks << " blocks of size "
+            << block_size << " (" << block_nnz << " non-zeros)\n";
+  std::cout << "Setup through operator() took: " << time_lookup << " micro-seconds\n";
+  std::cout << "Setup through submatrix() took: " << time_submatrix << " micro-seconds\n";
+  std::cout << "Max error of an arbitrary submatrix: " << max_err << "\n";
+
+  // zero-copy slices of the leading dimension
+  timer.start();
+  std::size_t slice_nnz = 0;
+  for (std::size_t b = 0; b < num_blocks; ++b) {
+    const std::size_t last = std::min(n, (b + 1) * block_size);
+    if constexpr (Store == StorageOrder::row) {
+      slice_nnz += matrix.row_slice(b * block_size, last).nnz();
+    } else {
+      slice_nnz += matrix.col_slice(b * block_size, last).nnz();
+    }
+  }
+  timer.stop();
+  std::cout << "Zero-copy slicing of all blocks (" << slice_nnz
+            << " non-zeros) took: " << timer.wallTime() << " micro-seconds\n";
+}
+
 public:
 // Test: read a matrix as a matrix-market file and print it.
 void test_file_reader(const std::string& file_name) {
@@ -235,6 +332,1537 @@ void large_benchmark_multiplication(std::size_t num_runs) {
             << avg_time_compressed << " micro-seconds\n";
   }
 
+// Test: partition the pattern into num_parts parts, compare the edge cut with
+// the one of contiguous row blocks and time the SpMV on the reordered matrix.
+// @param num_runs Number of runs to average the time over.
+void benchmark_partitioning(const std::string& file_name, std::size_t num_parts,
+                            std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto matrix_mapping = read_matrix<T, Store>(file_name);
+  auto matrix = Matrix<T, Store>(matrix_mapping);
+  matrix.compress();
+  const std::size_t n = std::max(matrix.rows(), matrix.cols());
+
+  // naive partition: contiguous blocks of rows
+  std::vector<std::size_t> blocks(n);
+  for (std::size_t i = 0; i < n; ++i) blocks[i] = i * num_parts / n;
+
+  timer.start();
+  auto parts = matrix.partition(num_parts);
+  timer.stop();
+  double time_partition = timer.wallTime();
+
+  std::vector<std::size_t> part_sizes(num_parts, 0);
+  for (auto p : parts) ++part_sizes[p];
+
+  auto perm = partition_permutation(parts, num_parts);
+  auto permuted = matrix.permute(perm);
+
+  // check P A P^T (P x) = P (A x)
+  std::vector<T> x = _generate_random_vector<T>(n);
+  auto y = matrix * x;
+  auto y_perm = permuted * permute_vector(x, perm);
+  T max_err = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    max_err = std::max(max_err, std::abs(y_perm[i] - y[perm[i]]));
+
+  double total_time_orig = 0.0;
+  double total_time_perm = 0.0;
+  for (std::size_t i = 0; i < num_runs; ++i) {
+    timer.start();
+    auto res_orig = matrix * x;
+    timer.stop();
+    total_time_orig += timer.wallTime();
+
+    timer.start();
+    auto res_perm = permuted * x;
+    timer.stop();
+    total_time_perm += timer.wallTime();
+  }
+
+  std::cout << "Partitioning " << file_name << " into " << num_parts << " parts\n";
+  std::cout << "Edge cut of contiguous row blocks: " << matrix.edge_cut(blocks) << "\n";
+  std::cout << "Edge cut of the graph partitioner: " << matrix.edge_cut(parts)
+            << " (parts of size " << *min_element(part_sizes.begin(), part_sizes.end())
+            << " to " << *max_element(part_sizes.begin(), part_sizes.end()) << ")\n";
+  std::cout << "Partitioning took: " << time_partition << " micro-seconds\n";
+  std::cout << "Max error of the permuted product: " << max_err << "\n";
+  std::cout << "Average time for ORIGINAL Multiplication: "
+            << total_time_orig / num_runs << " micro-seconds\n";
+  std::cout << "Average time for PERMUTED Multiplication: "
+            << total_time_perm / num_runs << " micro-seconds\n";
+}
+
+// Test: submatrix extraction for a block-Jacobi setup on the matrix-market
+// file and on a generated 2D Poisson matrix with num_points^2 rows.
+void benchmark_submatrix(const std::string& file_name, std::size_t num_points,
+                         std::size_t block_size) {
+  _print_test_case();
+  auto matrix_mapping = read_matrix<T, Store>(file_name);
+  auto matrix = Matrix<T, Store>(matrix_mapping);
+  matrix.compress();
+  std::cout << "Submatrix extraction on " << file_name << "\n";
+  _block_jacobi_setup(matrix, block_size);
+
+  auto poisson_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto poisson = Matrix<T, Store>(poisson_mapping);
+  poisson.compress();
+  std::cout << "Submatrix extraction on the 2D Poisson matrix of size "
+            << poisson.rows() << "\n";
+  _block_jacobi_setup(poisson, block_size);
+
+  // the submatrix keeps the size of the index sets, also when its last row and
+  // column are empty
+  typename Matrix<T, Store>::matrix_type small_mapping{
+      {{0, 0}, 1}, {{1, 1}, 2}, {{2, 0}, 3}};
+  auto small = Matrix<T, Store>(small_mapping);
+  small.compress();
+  const auto corner = small.submatrix({0, 1}, {0, 2});
+  const auto corner_product = corner * std::vector<T>{1, 1};
+  std::cout << "Submatrix A({0, 1}, {0, 2}) of a 3x3 matrix: " << corner.rows()
+            << "x" << corner.cols() << ", product of size "
+            << corner_product.size() << "\n";
+  if (corner.rows() != 2 || corner.cols() != 2 || corner_product.size() != 2) {
+    throw std::logic_error("The submatrix lost its empty last row or column");
+  }
+}
+
+// Test: traverse the matrix with the non-zero range and the row/col views,
+// compared with the traversal through operator().
+// @param num_runs Number of runs to average the time over.
+void benchmark_traversal(const std::string& file_name, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto matrix_mapping = read_matrix<T, Store>(file_name);
+  auto matrix = Matrix<T, Store>(matrix_mapping);
+  static_assert(std::ranges::forward_range<decltype(matrix.nonzeros())>);
+
+  // the non-zero range works in both states
+  auto is_diagonal = [](const auto& entry) { return entry.row == entry.col; };
+  const auto diag_uncomp = std::ranges::count_if(matrix.nonzeros(), is_diagonal);
+  matrix.compress();
+  const auto diag_comp = std::ranges::count_if(matrix.nonzeros(), is_diagonal);
+  std::cout << "Diagonal non-zeros (uncompressed, compressed): " << diag_uncomp
+            << ", " << diag_comp << "\n";
+
+  const Matrix<T, Store>& const_matrix = matrix;
+  const std::size_t n_rows = matrix.rows(), n_cols = matrix.cols();
+  std::vector<T> x = _generate_random_vector<T>(n_cols);
+  auto y_ref = matrix * x;
+
+  double time_lookup = 0.0, time_views = 0.0, time_range = 0.0;
+  std::vector<T> y_lookup, y_views, y_range;
+  for (std::size_t r = 0; r < num_runs; ++r) {
+    // element by element through the const operator()
+    timer.start();
+    y_lookup.assign(n_rows, 0);
+    for (std::size_t i = 0; i < n_rows; ++i)
+      for (std::size_t j = 0; j < n_cols; ++j) y_lookup[i] += const_matrix(i, j) * x[j];
+    timer.stop();
+    time_lookup += timer.wallTime();
+
+    // spans of the leading dimension
+    timer.start();
+    y_views.assign(n_rows, 0);
+    if constexpr (Store == StorageOrder::row) {
+      for (std::size_t i = 0; i < n_rows; ++i) {
+        const auto row = const_matrix.row(i);
+        for (std::size_t k = 0; k < row.size(); ++k)
+          y_views[i] += row.values[k] * x[row.indices[k]];
+      }
+    } else {
+      for (std::size_t j = 0; j < n_cols; ++j) {
+        const auto col = const_matrix.col(j);
+        for (std::size_t k = 0; k < col.size(); ++k)
+          y_views[col.indices[k]] += col.values[k] * x[j];
+      }
+    }
+    timer.stop();
+    time_views += timer.wallTime();
+
+    // non-zero range
+    timer.start();
+    y_range.assign(n_rows, 0);
+    for (const auto& [i, j, v] : const_matrix.nonzeros()) y_range[i] += v * x[j];
+    timer.stop();
+    time_range += timer.wallTime();
+  }
+
+  T max_err = 0;
+  for (std::size_t i = 0; i < n_rows; ++i) {
+    max_err = std::max({max_err, std::abs(y_lookup[i] - y_ref[i]),
+                        std::abs(y_views[i] - y_ref[i]), std::abs(y_range[i] - y_ref[i])});
+  }
+  std::cout << "Max error of the traversals: " << max_err << "\n";
+  std::cout << "Average time for operator() traversal: " << time_lookup / num_runs
+            << " micro-seconds\n";
+  std::cout << "Average time for row/col view traversal: " << time_views / num_runs
+            << " micro-seconds\n";
+  std::cout << "Average time for non-zero range traversal: " << time_range / num_runs
+            << " micro-seconds\n";
+}
+
+// Test: block-Jacobi preconditioner on a generated 2D Poisson matrix with
+// num_points^2 rows: extraction, batched factorization, apply and sweeps.
+void benchmark_block_jacobi(std::size_t num_points, std::size_t block_size,
+                            std::size_t num_sweeps) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto matrix_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto matrix = Matrix<T, Store>(matrix_mapping);
+  matrix.compress();
+  const Matrix<T, Store>& const_matrix = matrix;
+  const std::size_t n = matrix.rows();
+
+  // old path: dense blocks through operator()
+  timer.start();
+  BlockDiagonal<T> diag_lookup(n, block_size);
+  for (std::size_t b = 0; b < diag_lookup.num_blocks(); ++b) {
+    auto blk = diag_lookup.block(b);
+    const std::size_t first = b * block_size;
+    for (std::size_t i = 0; i < std::min(block_size, n - first); ++i)
+      for (std::size_t j = 0; j < std::min(block_size, n - first); ++j)
+        blk[i * block_size + j] = const_matrix(first + i, first + j);
+  }
+  timer.stop();
+  double time_lookup = timer.wallTime();
+
+  timer.start();
+  auto diag = matrix.extract_block_diagonal(block_size);
+  timer.stop();
+  double time_extract = timer.wallTime();
+
+  timer.start();
+  diag.factorize();
+  timer.stop();
+  double time_factorize = timer.wallTime();
+
+  // D^{-1} (D x) = x
+  std::vector<T> x = _generate_random_vector<T>(n);
+  timer.start();
+  auto z = diag.apply(diag * x);
+  timer.stop();
+  double time_apply = timer.wallTime();
+  T max_err = 0;
+  for (std::size_t i = 0; i < n; ++i) max_err = std::max(max_err, std::abs(z[i] - x[i]));
+
+  std::cout << "Block-Jacobi on the 2D Poisson matrix of size " << n << " with blocks of size "
+            << block_size << "\n";
+  std::cout << "Extraction through operator() took: " << time_lookup << " micro-seconds\n";
+  std::cout << "extract_block_diagonal() took: " << time_extract << " micro-seconds\n";
+  std::cout << "Batched LU + inverse took: " << time_factorize << " micro-seconds\n";
+  std::cout << "Apply took: " << time_apply << " micro-seconds, max error of D^{-1} D x: "
+            << max_err << "\n";
+
+  if constexpr (Store == StorageOrder::row) {
+    // fused sweeps on A x = A 1
+    std::vector<T> ones(n, 1);
+    auto rhs = matrix * ones;
+    std::vector<T> sol(n, 0);
+    timer.start();
+    for (std::size_t s = 0; s < num_sweeps; ++s) diag.sweep(matrix, rhs, sol, T(1));
+    timer.stop();
+    auto res = matrix * sol;
+    T res_norm = 0, rhs_norm = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      res_norm += (rhs[i] - res[i]) * (rhs[i] - res[i]);
+      rhs_norm += rhs[i] * rhs[i];
+    }
+    std::cout << num_sweeps << " fused block-Jacobi sweeps took: " << timer.wallTime()
+              << " micro-seconds, relative residual " << std::sqrt(res_norm / rhs_norm) << "\n";
+  }
+}
+
+// Test: multicolor Gauss-Seidel on a generated 2D Poisson matrix (always
+// row-major) with num_points^2 rows, compared with the serial natural sweep.
+void benchmark_gauss_seidel(std::size_t num_points, std::size_t num_sweeps) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto matrix_mapping = poisson_matrix<T, StorageOrder::row>(num_points, 2);
+  auto matrix = Matrix<T, StorageOrder::row>(matrix_mapping);
+  matrix.compress();
+  const std::size_t n = matrix.rows();
+
+  timer.start();
+  MulticolorGaussSeidel<T> smoother(matrix);
+  timer.stop();
+  std::cout << "Multicolor Gauss-Seidel on the 2D Poisson matrix of size " << n << "\n";
+  std::cout << "Setup with " << smoother.num_colors()
+            << " colors took: " << timer.wallTime() << " micro-seconds\n";
+
+  std::vector<T> ones(n, 1);
+  auto rhs = matrix * ones;
+  auto relative_residual = [&](const std::vector<T>& x) {
+    auto res = matrix * x;
+    T res_norm = 0, rhs_norm = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      res_norm += (rhs[i] - res[i]) * (rhs[i] - res[i]);
+      rhs_norm += rhs[i] * rhs[i];
+    }
+    return std::sqrt(res_norm / rhs_norm);
+  };
+
+  for (auto direction : {SweepDirection::forward, SweepDirection::backward,
+                         SweepDirection::symmetric}) {
+    std::vector<T> x_serial(n, 0), x_color(n, 0);
+    timer.start();
+    for (std::size_t s = 0; s < num_sweeps; ++s) smoother.sweep_natural(rhs, x_serial, direction);
+    timer.stop();
+    double time_serial = timer.wallTime();
+
+    timer.start();
+    for (std::size_t s = 0; s < num_sweeps; ++s) smoother.sweep(rhs, x_color, direction);
+    timer.stop();
+    double time_color = timer.wallTime();
+
+    std::cout << "Direction (0 = forward, 1 = backward, 2 = symmetric) " << direction
+              << ": serial " << num_sweeps * 1e6 / time_serial
+              << " sweeps/s (residual " << relative_residual(x_serial) << "), multicolor "
+              << num_sweeps * 1e6 / time_color << " sweeps/s (residual "
+              << relative_residual(x_color) << ")\n";
+  }
+
+  // over-relaxation
+  std::vector<T> x_sor(n, 0);
+  for (std::size_t s = 0; s < num_sweeps; ++s)
+    smoother.sweep(rhs, x_sor, SweepDirection::symmetric, T(1.5));
+  std::cout << "Symmetric SOR with omega = 1.5, residual " << relative_residual(x_sor) << "\n";
+}
+
+// Test: smoothed aggregation AMG on generated 3D Poisson matrices (always
+// row-major) with num_points^3 rows, compared with Jacobi-preconditioned CG.
+void benchmark_amg(const std::vector<std::size_t>& num_points, T tol) {
+  _print_test_case();
+  Timings::Chrono timer;
+  for (auto points : num_points) {
+    auto matrix_mapping = poisson_matrix<T, StorageOrder::row>(points, 3);
+    auto matrix = Matrix<T, StorageOrder::row>(matrix_mapping);
+    matrix.compress();
+    const std::size_t n = matrix.rows();
+    std::vector<T> ones(n, 1);
+    auto rhs = matrix * ones;
+
+    timer.start();
+    AMG<T> amg(matrix);
+    timer.stop();
+    double time_setup = timer.wallTime();
+
+    std::vector<T> z(n);
+    timer.start();
+    amg.apply(rhs, z);
+    timer.stop();
+    double time_cycle = timer.wallTime();
+
+    std::vector<T> x_amg(n, 0);
+    timer.start();
+    auto it_amg = conjugate_gradient(matrix, rhs, x_amg, amg, tol, 1000);
+    timer.stop();
+    double time_amg = timer.wallTime();
+
+    auto jacobi = matrix.extract_block_diagonal(1);
+    jacobi.factorize();
+    std::vector<T> x_jacobi(n, 0);
+    timer.start();
+    auto it_jacobi = conjugate_gradient(matrix, rhs, x_jacobi, jacobi, tol, 10000);
+    timer.stop();
+    double time_jacobi = timer.wallTime();
+
+    std::cout << "AMG on the 3D Poisson matrix of size " << n << ": " << amg.num_levels()
+              << " levels (";
+    for (auto size : amg.level_sizes()) std::cout << size << " ";
+    std::cout << "rows), operator complexity " << amg.operator_complexity() << "\n";
+    std::cout << "Setup took: " << time_setup << " micro-seconds, one V-cycle took: "
+              << time_cycle << " micro-seconds\n";
+    std::cout << "CG + AMG: " << it_amg << " iterations, " << time_amg << " micro-seconds\n";
+    std::cout << "CG + Jacobi: " << it_jacobi << " iterations, " << time_jacobi
+              << " micro-seconds\n";
+
+    // two levels only, the coarsest level may be too large for the dense LU
+    AMG<T> two_level(matrix, 0, 200, 2);
+    std::vector<T> x_two_level(n, 0);
+    timer.start();
+    auto it_two_level = conjugate_gradient(matrix, rhs, x_two_level, two_level, tol, 1000);
+    timer.stop();
+    std::cout << "CG + two-level AMG (" << two_level.level_sizes().back() << " coarse rows, "
+              << (two_level.has_direct_coarse_solve() ? "dense LU" : "Gauss-Seidel sweeps")
+              << "): " << it_two_level << " iterations, " << timer.wallTime()
+              << " micro-seconds\n";
+  }
+}
+
+// Test: extreme eigenvalue estimates against the norms, which bound the
+// spectral radius. On the matrix-market file (non-symmetric) only the power
+// iteration applies, on a generated 2D Poisson matrix with num_points^2 rows
+// the exact extreme eigenvalues 8 sin^2(pi h / 2) and 8 cos^2(pi h / 2) are known.
+void benchmark_eigenvalues(const std::string& file_name, std::size_t num_points, T tol) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto norms = [&](const Matrix<T, Store>& matrix) {
+    timer.start();
+    auto frob = matrix.template norm<NormOrder::frob>();
+    auto one = matrix.template norm<NormOrder::one>();
+    auto max = matrix.template norm<NormOrder::max>();
+    timer.stop();
+    std::cout << "Norms: frob = " << frob << ", one = " << one << ", max = " << max
+              << ", all three took: " << timer.wallTime() << " micro-seconds\n";
+  };
+
+  auto file_mapping = read_matrix<T, Store>(file_name);
+  auto file_matrix = Matrix<T, Store>(file_mapping);
+  file_matrix.compress();
+  std::cout << "Matrix " << file_name << "\n";
+  norms(file_matrix);
+  timer.start();
+  auto power_file = power_iteration(file_matrix, 1000, tol);
+  timer.stop();
+  std::cout << "Power iteration: spectral radius " << power_file.value << " after "
+            << power_file.iterations << " iterations (converged " << power_file.converged
+            << "), took: " << timer.wallTime() << " micro-seconds\n";
+
+  auto poisson_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto poisson = Matrix<T, Store>(poisson_mapping);
+  poisson.compress();
+  const T h = T(1) / (num_points + 1);
+  const T exact_min = 8 * std::pow(std::sin(std::numbers::pi_v<T> * h / 2), 2);
+  const T exact_max = 8 * std::pow(std::cos(std::numbers::pi_v<T> * h / 2), 2);
+  std::cout << "2D Poisson matrix of size " << poisson.rows() << ", exact eigenvalues in ["
+            << exact_min << ", " << exact_max << "]\n";
+  norms(poisson);
+
+  timer.start();
+  auto power = power_iteration(poisson, 1000, tol);
+  timer.stop();
+  std::cout << "Power iteration: " << power.value << " after " << power.iterations
+            << " iterations, took: " << timer.wallTime() << " micro-seconds\n";
+
+  timer.start();
+  auto lanczos = lanczos_bounds(poisson, 100, tol);
+  timer.stop();
+  std::cout << "Lanczos: [" << lanczos.min << ", " << lanczos.max << "] after "
+            << lanczos.iterations << " steps, took: " << timer.wallTime() << " micro-seconds\n";
+
+  // eigenvalues of D^{-1} A, i.e. the exact ones divided by 4
+  auto jacobi = poisson.extract_block_diagonal(1);
+  jacobi.factorize();
+  timer.start();
+  auto lanczos_jacobi = lanczos_bounds(poisson, 100, tol, jacobi);
+  timer.stop();
+  std::cout << "Lanczos on D^{-1} A: [" << lanczos_jacobi.min << ", " << lanczos_jacobi.max
+            << "] (exact [" << exact_min / 4 << ", " << exact_max / 4 << "]) after "
+            << lanczos_jacobi.iterations << " steps, took: " << timer.wallTime()
+            << " micro-seconds\n";
+}
+
+// Test: CG preconditioned by Chebyshev polynomials of increasing degree against
+// Jacobi-preconditioned CG on a generated 2D Poisson matrix with num_points^2
+// rows, and the residual reduction of Chebyshev sweeps used as smoother.
+void benchmark_chebyshev(std::size_t num_points, const std::vector<std::size_t>& degrees,
+                         T tol) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto matrix_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto matrix = Matrix<T, Store>(matrix_mapping);
+  matrix.compress();
+  const std::size_t n = matrix.rows();
+  std::vector<T> ones(n, 1);
+  const auto rhs = matrix * ones;
+  const T rhs_norm = std::sqrt(_dot(rhs, rhs));
+  std::cout << "Chebyshev on the 2D Poisson matrix of size " << n << "\n";
+
+  auto jacobi = matrix.extract_block_diagonal(1);
+  jacobi.factorize();
+  std::vector<T> x_jacobi(n, 0);
+  timer.start();
+  auto it_jacobi = conjugate_gradient(matrix, rhs, x_jacobi, jacobi, tol, 10000);
+  timer.stop();
+  std::cout << "CG + Jacobi: " << it_jacobi << " iterations, " << timer.wallTime()
+            << " micro-seconds\n";
+
+  for (auto degree : degrees) {
+    timer.start();
+    Chebyshev<T, Store> chebyshev(matrix, degree);
+    timer.stop();
+    double time_setup = timer.wallTime();
+
+    std::vector<T> x(n, 0);
+    timer.start();
+    auto it = conjugate_gradient(matrix, rhs, x, chebyshev, tol, 10000);
+    timer.stop();
+    double time_cg = timer.wallTime();
+
+    std::vector<T> x_smooth(n, 0), res(n);
+    timer.start();
+    for (std::size_t s = 0; s < 10; ++s) chebyshev.sweep(rhs, x_smooth);
+    timer.stop();
+    double time_sweeps = timer.wallTime();
+    matrix.multiply(x_smooth, res);
+    for (std::size_t i = 0; i < n; ++i) res[i] = rhs[i] - res[i];
+
+    std::cout << "Degree " << degree << ": setup " << time_setup << " micro-seconds (lambda_max "
+              << chebyshev.lambda_max() << "), CG + Chebyshev " << it << " iterations, "
+              << time_cg << " micro-seconds, 10 sweeps " << time_sweeps
+              << " micro-seconds (residual " << std::sqrt(_dot(res, res)) / rhs_norm << ")\n";
+  }
+}
+
+// Test: sparse LU with the natural and the nested dissection ordering against
+// GMRES(30) on matrix-market files and on a generated 2D Poisson matrix with
+// num_points^2 rows. The LU reports the analysis, factorization,
+// refactorization and solve times and the fill, i.e. the non-zeros of L + U
+// over the ones of A.
+void benchmark_sparse_lu(const std::vector<std::string>& file_names, std::size_t num_points,
+                         T tol) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto run = [&](const Matrix<T, Store>& matrix, const std::string& name) {
+    const std::size_t n = matrix.rows();
+    std::vector<T> ones(n, 1);
+    const auto rhs = matrix * ones;
+    auto relative_residual = [&](const std::vector<T>& x) {
+      auto res = matrix * x;
+      for (std::size_t i = 0; i < n; ++i) res[i] = rhs[i] - res[i];
+      return std::sqrt(_dot(res, res) / _dot(rhs, rhs));
+    };
+    std::cout << "Matrix " << name << " of size " << n << " with " << matrix.nnz()
+              << " non-zeros\n";
+
+    for (bool reorder : {false, true}) {
+      timer.start();
+      SparseLU<T> lu(matrix, reorder);
+      timer.stop();
+      double time_analysis = timer.wallTime();
+
+      timer.start();
+      lu.factorize(matrix);
+      timer.stop();
+      double time_factorize = timer.wallTime();
+
+      timer.start();
+      lu.refactorize(matrix);
+      timer.stop();
+      double time_refactorize = timer.wallTime();
+
+      std::vector<T> x(n);
+      timer.start();
+      lu.solve(rhs, x);
+      timer.stop();
+      double time_solve = timer.wallTime();
+
+      std::cout << (reorder ? "Nested dissection" : "Natural ordering") << ": analysis "
+                << time_analysis << ", factorization " << time_factorize << ", refactorization "
+                << time_refactorize << ", solve " << time_solve << " micro-seconds, fill "
+                << static_cast<double>(lu.nnz_factors()) / matrix.nnz() << ", residual "
+                << relative_residual(x) << "\n";
+    }
+
+    std::vector<T> x_gmres(n, 0);
+    timer.start();
+    auto it = gmres(matrix, rhs, x_gmres, IdentityPreconditioner<T>(), tol, 2000);
+    timer.stop();
+    std::cout << "GMRES(30): " << it << " iterations, " << timer.wallTime()
+              << " micro-seconds, residual " << relative_residual(x_gmres) << "\n";
+  };
+
+  for (const auto& file_name : file_names) {
+    auto matrix_mapping = read_matrix<T, Store>(file_name);
+    auto matrix = Matrix<T, Store>(matrix_mapping);
+    matrix.compress();
+    run(matrix, file_name);
+  }
+  auto poisson_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto poisson = Matrix<T, Store>(poisson_mapping);
+  poisson.compress();
+  run(poisson, "2D Poisson");
+}
+
+// Test: supernodal Cholesky on generated 2D Poisson matrices (always
+// col-major) with num_points^2 rows: symbolic and numeric factorization,
+// supernodes, fill and solve, against the sparse LU with the same ordering.
+void benchmark_cholesky(const std::vector<std::size_t>& num_points) {
+  _print_test_case();
+  Timings::Chrono timer;
+  for (auto points : num_points) {
+    auto matrix_mapping = poisson_matrix<T, StorageOrder::col>(points, 2);
+    auto matrix = Matrix<T, StorageOrder::col>(matrix_mapping);
+    matrix.compress();
+    const std::size_t n = matrix.rows();
+    std::vector<T> ones(n, 1);
+    const auto rhs = matrix * ones;
+    auto relative_residual = [&](const std::vector<T>& x) {
+      auto res = matrix * x;
+      for (std::size_t i = 0; i < n; ++i) res[i] = rhs[i] - res[i];
+      return std::sqrt(_dot(res, res) / _dot(rhs, rhs));
+    };
+
+    timer.start();
+    SparseCholesky<T> cholesky(matrix);
+    timer.stop();
+    double time_symbolic = timer.wallTime();
+
+    timer.start();
+    cholesky.factorize(matrix);
+    timer.stop();
+    double time_numeric = timer.wallTime();
+
+    std::vector<T> x(n);
+    timer.start();
+    cholesky.solve(rhs, x);
+    timer.stop();
+    double time_solve = timer.wallTime();
+
+    std::cout << "Cholesky of the 2D Poisson matrix of size " << n << ": "
+              << cholesky.num_supernodes() << " supernodes in " << cholesky.num_levels()
+              << " levels, nnz(L) = " << cholesky.nnz_factor() << "\n";
+    std::cout << "Symbolic " << time_symbolic << ", numeric " << time_numeric << ", solve "
+              << time_solve << " micro-seconds, residual " << relative_residual(x) << "\n";
+
+    timer.start();
+    SparseLU<T> lu(matrix);
+    lu.factorize(matrix);
+    timer.stop();
+    double time_lu = timer.wallTime();
+    timer.start();
+    lu.solve(rhs, x);
+    timer.stop();
+    std::cout << "Sparse LU: analysis + factorization " << time_lu << ", solve "
+              << timer.wallTime() << " micro-seconds, nnz(L + U) = " << lu.nnz_factors() << "\n";
+  }
+}
+
+// Test: Kronecker products. kron_sum of two 1D Poisson matrices has to be the
+// 2D Poisson matrix. kron of the matrix-market file with a 1D Poisson matrix of
+// size num_points is assembled through the map and directly in compressed
+// format, and its product is compared with the implicit Kronecker operator.
+void benchmark_kronecker(const std::string& file_name, std::size_t num_points,
+                         std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto poisson_1d_mapping = poisson_matrix<T, Store>(num_points, 1);
+  auto poisson_1d = Matrix<T, Store>(poisson_1d_mapping);
+  poisson_1d.compress();
+  auto poisson_2d_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto poisson_2d = Matrix<T, Store>(poisson_2d_mapping);
+  poisson_2d.compress();
+  const auto sum = kron_sum(poisson_1d, poisson_1d);
+  const auto x_2d = _generate_random_vector<T>(poisson_2d.cols());
+  const auto y_sum = sum * x_2d, y_2d = poisson_2d * x_2d;
+  T error_sum = 0;
+  for (std::size_t i = 0; i < y_2d.size(); ++i) error_sum = std::max(error_sum, std::abs(y_sum[i] - y_2d[i]));
+  std::cout << "kron_sum of two 1D Poisson matrices: " << sum.nnz() << " non-zeros (2D Poisson "
+            << poisson_2d.nnz() << "), max difference of the products " << error_sum << "\n";
+
+  auto file_mapping = read_matrix<T, Store>(file_name);
+  auto file_matrix = Matrix<T, Store>(file_mapping);
+  file_matrix.compress();
+
+  // assembly through the map, the way a user would do it without kron
+  timer.start();
+  std::map<std::array<std::size_t, 2>, T,
+           std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>, ColOrderComparator<T>>>
+      kron_mapping;
+  const std::size_t b_rows = poisson_1d.rows(), b_cols = poisson_1d.cols();
+  for (auto a : file_matrix.nonzeros())
+    for (auto b : poisson_1d.nonzeros())
+      kron_mapping[{a.row * b_rows + b.row, a.col * b_cols + b.col}] = a.value * b.value;
+  auto kron_map = Matrix<T, Store>(kron_mapping);
+  kron_map.compress();
+  timer.stop();
+  double time_map = timer.wallTime();
+
+  timer.start();
+  const auto product = kron(file_matrix, poisson_1d);
+  timer.stop();
+  double time_direct = timer.wallTime();
+  std::cout << "kron of " << file_name << " and the 1D Poisson matrix: size " << product.rows()
+            << ", " << product.nnz() << " non-zeros, assembly through the map " << time_map
+            << ", direct " << time_direct << " micro-seconds\n";
+
+  const KroneckerOperator<T, Store> op(file_matrix, poisson_1d);
+  const auto x = _generate_random_vector<T>(op.cols());
+  std::vector<T> y_assembled, y_implicit;
+  timer.start();
+  for (std::size_t r = 0; r < num_runs; ++r) product.multiply(x, y_assembled);
+  timer.stop();
+  double time_assembled = timer.wallTime() / num_runs;
+  timer.start();
+  for (std::size_t r = 0; r < num_runs; ++r) op.multiply(x, y_implicit);
+  timer.stop();
+  double time_implicit = timer.wallTime() / num_runs;
+  T error = 0, scale = 0;
+  for (std::size_t i = 0; i < y_assembled.size(); ++i) {
+    error = std::max(error, std::abs(y_assembled[i] - y_implicit[i]));
+    scale = std::max(scale, std::abs(y_assembled[i]));
+  }
+  std::cout << "Product: assembled " << time_assembled << ", implicit " << time_implicit
+            << " micro-seconds, max relative difference " << error / scale << "\n";
+}
+
+// Test: hybrid dense/sparse storage on generated 2D Poisson matrices with
+// num_points^2 rows and num_blocks embedded dense blocks of every size in
+// block_sizes. The product of the hybrid storage is compared with the compressed
+// one, the plain Poisson matrix must not produce any dense block.
+void benchmark_dense_blocks(std::size_t num_points, std::size_t num_blocks,
+                            const std::vector<std::size_t>& block_sizes, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto poisson_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto poisson = Matrix<T, Store>(poisson_mapping);
+  poisson.compress();
+  const DenseBlockMatrix<T, Store> poisson_hybrid(poisson);
+  std::cout << "2D Poisson with " << poisson.rows() << " rows: " << poisson_hybrid.num_blocks()
+            << " dense blocks detected\n";
+
+  for (auto block_size : block_sizes) {
+    auto mapping = dense_block_matrix<T, Store>(num_points, num_blocks, block_size);
+    auto matrix = Matrix<T, Store>(mapping);
+    matrix.compress();
+    timer.start();
+    const DenseBlockMatrix<T, Store> hybrid(matrix);
+    timer.stop();
+    double time_setup = timer.wallTime();
+
+    const auto x = _generate_random_vector<T>(matrix.cols());
+    std::vector<T> y_compressed, y_hybrid;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y_compressed);
+    timer.stop();
+    double time_compressed = timer.wallTime() / num_runs;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) hybrid.multiply(x, y_hybrid);
+    timer.stop();
+    double time_hybrid = timer.wallTime() / num_runs;
+    T error = 0, scale = 0;
+    for (std::size_t i = 0; i < y_compressed.size(); ++i) {
+      error = std::max(error, std::abs(y_compressed[i] - y_hybrid[i]));
+      scale = std::max(scale, std::abs(y_compressed[i]));
+    }
+    std::cout << num_blocks << " blocks of size " << block_size << " (" << matrix.nnz()
+              << " non-zeros): " << hybrid.num_blocks() << " dense rectangles with "
+              << hybrid.dense_entries() << " entries, " << hybrid.sparse_nnz()
+              << " sparse non-zeros, setup " << time_setup << " micro-seconds\n";
+    std::cout << "Product: compressed " << time_compressed << ", hybrid " << time_hybrid
+              << " micro-seconds, max relative difference " << error / scale << "\n";
+  }
+}
+
+// Test: CSR matrix-vector product with the rows binned by length against a
+// single loop over the rows, on the matrix-market file and on generated
+// matrices with power-law row lengths (size rows, longest rows of the given
+// lengths). The binning is a CSR feature, the matrices are always row-major.
+void benchmark_row_bins(const std::string& file_name, std::size_t size,
+                        const std::vector<std::size_t>& max_row_lengths, std::size_t num_runs) {
+  _print_test_case();
+  using RowMatrix = Matrix<T, StorageOrder::row>;
+  Timings::Chrono timer;
+  auto run = [&](const std::string& name, RowMatrix& matrix) {
+    const auto x = _generate_random_vector<T>(matrix.cols());
+    const std::size_t n_rows = matrix.rows();
+    std::vector<T> y_loop(n_rows), y_binned;
+    auto single_loop = [&]() {
+#pragma omp parallel for schedule(static)
+      for (std::size_t i = 0; i < n_rows; ++i) {
+        const auto row = matrix.row(i);
+        T sum = 0;
+        for (std::size_t k = 0; k < row.size(); ++k) sum += row.values[k] * x[row.indices[k]];
+        y_loop[i] = sum;
+      }
+    };
+    // one call of each kernel before timing, which also allocates y_binned
+    single_loop();
+    matrix.multiply(x, y_binned);
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) single_loop();
+    timer.stop();
+    double time_loop = timer.wallTime() / num_runs;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y_binned);
+    timer.stop();
+    double time_binned = timer.wallTime() / num_runs;
+    T error = 0, scale = 0;
+    for (std::size_t i = 0; i < y_loop.size(); ++i) {
+      error = std::max(error, std::abs(y_loop[i] - y_binned[i]));
+      scale = std::max(scale, std::abs(y_loop[i]));
+    }
+    const auto bins = matrix.row_bin_sizes();
+    std::cout << name << " (" << matrix.rows() << " rows, " << matrix.nnz() << " non-zeros): "
+              << bins[0] << " short, " << bins[1] << " medium, " << bins[2] << " long rows\n";
+    std::cout << "Product: single loop " << time_loop << ", binned " << time_binned
+              << " micro-seconds, max relative difference " << error / scale << "\n";
+  };
+
+  auto file_mapping = read_matrix<T, StorageOrder::row>(file_name);
+  auto file_matrix = RowMatrix(file_mapping);
+  file_matrix.compress();
+  run(file_name, file_matrix);
+  for (auto max_row_length : max_row_lengths) {
+    auto mapping = power_law_matrix<T, StorageOrder::row>(size, max_row_length);
+    auto matrix = RowMatrix(mapping);
+    matrix.compress();
+    run("Power-law rows up to " + std::to_string(max_row_length), matrix);
+  }
+}
+
+// Test: deterministic mode. The matrix-vector product, the scalar product and
+// GMRES are run with 1 to max_threads threads on the matrix-market file and on a
+// generated 2D Poisson matrix with num_points^2 rows; in the deterministic mode
+// the results have to be bitwise identical to the ones with one thread, else
+// std::logic_error is thrown and the driver fails. Then the time of both modes
+// with max_threads threads.
+void test_deterministic(const std::string& file_name, std::size_t num_points,
+                        int max_threads, std::size_t num_runs) {
+  _print_test_case();
+#ifdef _OPENMP
+  const int default_threads = omp_get_max_threads();
+  auto set_threads = [](int num_threads) { omp_set_num_threads(num_threads); };
+#else
+  const int default_threads = 1;
+  auto set_threads = [](int) {};
+#endif
+  Timings::Chrono timer;
+  auto file_mapping = read_matrix<T, Store>(file_name);
+  auto file_matrix = Matrix<T, Store>(file_mapping);
+  file_matrix.compress();
+  auto poisson_mapping = poisson_matrix<T, Store>(num_points, 2);
+  auto poisson = Matrix<T, Store>(poisson_mapping);
+  poisson.compress();
+
+  auto run = [&](const std::string& name, const Matrix<T, Store>& matrix) {
+    const auto x = _generate_random_vector<T>(matrix.cols());
+    const std::vector<T> rhs = matrix * x;
+    for (bool deterministic : {false, true}) {
+      set_deterministic(deterministic);
+      std::vector<T> y_first, sol_first;
+      T dot_first = 0;
+      bool identical = true;
+      for (int num_threads = 1; num_threads <= max_threads; ++num_threads) {
+        set_threads(num_threads);
+        std::vector<T> y, sol(matrix.cols(), 0);
+        matrix.multiply(x, y);
+        const T dot = _dot(y, x);
+        gmres(matrix, rhs, sol, IdentityPreconditioner<T>(), T(1e-12), 50);
+        if (num_threads == 1) {
+          y_first = y;
+          dot_first = dot;
+          sol_first = sol;
+        } else {
+          identical = identical && y == y_first && dot == dot_first && sol == sol_first;
+        }
+      }
+      std::cout << name << ", " << (deterministic ? "deterministic" : "fast")
+                << " mode: product, scalar product and 50 GMRES iterations with 1 to " << max_threads
+                << " threads " << (identical ? "identical" : "NOT identical") << "\n";
+      // the fast mode is only informational, the deterministic one must not depend on the threads
+      if (deterministic && !identical) {
+        set_deterministic(false);
+        set_threads(default_threads);
+        throw std::logic_error("The deterministic mode gives different results for different numbers of threads");
+      }
+    }
+
+    set_threads(max_threads);
+    std::vector<T> y;
+    for (bool deterministic : {false, true}) {
+      set_deterministic(deterministic);
+      matrix.multiply(x, y);
+      timer.start();
+      for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y);
+      timer.stop();
+      double time_product = timer.wallTime() / num_runs;
+      T dot = 0;
+      timer.start();
+      for (std::size_t r = 0; r < num_runs; ++r) dot += _dot(y, x);
+      timer.stop();
+      std::cout << (deterministic ? "Deterministic" : "Fast") << " mode with " << max_threads
+                << " threads: product " << time_product << ", scalar product "
+                << timer.wallTime() / num_runs << " micro-seconds\n";
+    }
+  };
+  run(file_name, file_matrix);
+  run("2D Poisson with " + std::to_string(poisson.rows()) + " rows", poisson);
+  set_deterministic(false);
+  set_threads(default_threads);
+}
+
+// Test: memory footprint of the matrix-market file and of generated 2D Poisson
+// matrices with num_points^2 rows. For reading (or generating) the mapping,
+// compress() and uncompress() the growth of the peak resident set size is
+// compared with the estimate of memory_usage() after the step.
+void benchmark_memory(const std::string& file_name, const std::vector<std::size_t>& num_points) {
+  _print_test_case();
+  constexpr double mega = 1024 * 1024;
+  auto step = [this](auto&& operation) {
+    _reset_peak_rss();
+    const std::size_t before = _rss_bytes("VmRSS");
+    operation();
+    const std::size_t peak = _rss_bytes("VmHWM");
+    return (peak > before ? peak - before : 0) / mega;
+  };
+  auto run = [&](const std::string& name, auto&& make_mapping) {
+    typename Matrix<T, Store>::matrix_type mapping;
+    const double peak_read = step([&] { mapping = make_mapping(); });
+    auto matrix = Matrix<T, Store>(mapping);
+    const auto read = matrix.memory_usage();
+    const double peak_compress = step([&] { matrix.compress(); });
+    const auto compressed = matrix.memory_usage();
+    const double peak_uncompress = step([&] { matrix.uncompress(); });
+    const auto uncompressed = matrix.memory_usage();
+    std::cout << name << " (" << matrix.nnz() << " non-zeros), peak RSS growth / memory_usage() in MB:\n";
+    std::cout << "  read: " << peak_read << " / map " << read.dynamic / mega << "\n";
+    std::cout << "  compress: " << peak_compress << " / compressed " << compressed.compressed / mega
+              << ", caches " << compressed.caches / mega << "\n";
+    std::cout << "  uncompress: " << peak_uncompress << " / map " << uncompressed.dynamic / mega << "\n";
+  };
+  run(file_name, [&] { return read_matrix<T, Store>(file_name); });
+  for (auto points : num_points)
+    run("2D Poisson with " + std::to_string(points * points) + " rows",
+        [points] { return poisson_matrix<T, Store>(points, 2); });
+}
+
+// Test: assembly of a generated 2D Poisson matrix with num_points^2 rows from a
+// stream of entries, once sorted in the storage order and once shuffled, into
+// the mapping and into the hash table, both followed by compress().
+void benchmark_assembly(std::size_t num_points) {
+  _print_test_case();
+  Timings::Chrono timer;
+  std::vector<NonZero<T>> sorted;
+  for (const auto& [k, v] : poisson_matrix<T, Store>(num_points, 2)) sorted.push_back({k[0], k[1], v});
+  auto shuffled = sorted;
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+  const auto x = _generate_random_vector<T>(num_points * num_points);
+
+  for (const auto* stream : {&sorted, &shuffled}) {
+    timer.start();
+    typename Matrix<T, Store>::matrix_type mapping;
+    for (const auto& e : *stream) mapping[{e.row, e.col}] = e.value;
+    auto from_map = Matrix<T, Store>(mapping);
+    from_map.compress();
+    timer.stop();
+    double time_map = timer.wallTime();
+
+    timer.start();
+    HashMatrix<T, Store> hash;
+    for (const auto& e : *stream) hash(e.row, e.col) = e.value;
+    const auto from_hash = hash.compress();
+    timer.stop();
+    double time_hash = timer.wallTime();
+
+    const auto y_map = from_map * x, y_hash = from_hash * x;
+    std::cout << (stream == &sorted ? "Sorted" : "Random") << " stream of " << stream->size()
+              << " entries: mapping + compress " << time_map << ", hash table + compress "
+              << time_hash << " micro-seconds, same products " << (y_map == y_hash) << "\n";
+  }
+}
+
+// Test: finite volume assembly of a 2D Poisson matrix with num_points^2 rows,
+// every cell adds the fluxes through its faces to its own row (column), into
+// the mapping (serial) and into the list-of-lists storage (parallel over the
+// rows). Then the uncompressed products and norms of both, and compress().
+void benchmark_row_lists(std::size_t num_points, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  const std::size_t n = num_points * num_points;
+  // the neighbours of cell c, -1 on the diagonal and 1 towards every neighbour
+  auto assemble = [num_points](std::size_t c, auto&& add) {
+    const std::size_t i = c % num_points, j = c / num_points;
+    add(c, c, 4);
+    if (i > 0) add(c, c - 1, -1);
+    if (i + 1 < num_points) add(c, c + 1, -1);
+    if (j > 0) add(c, c - num_points, -1);
+    if (j + 1 < num_points) add(c, c + num_points, -1);
+  };
+  // the cell owns row c, or column c in the col-major case
+  auto index = [](std::size_t c, std::size_t k) {
+    return Store == StorageOrder::row ? std::array<std::size_t, 2>{c, k} : std::array<std::size_t, 2>{k, c};
+  };
+
+  timer.start();
+  typename Matrix<T, Store>::matrix_type mapping;
+  for (std::size_t c = 0; c < n; ++c)
+    assemble(c, [&](std::size_t o, std::size_t k, T v) { mapping[index(o, k)] += v; });
+  timer.stop();
+  double time_map = timer.wallTime();
+  timer.start();
+  LilMatrix<T, Store> lists(n, n);
+#pragma omp parallel for schedule(static)
+  for (std::size_t c = 0; c < n; ++c)
+    assemble(c, [&](std::size_t o, std::size_t k, T v) {
+      const auto [row, col] = index(o, k);
+      lists(row, col) += v;
+    });
+  timer.stop();
+  double time_lists = timer.wallTime();
+  std::cout << "Assembly of " << mapping.size() << " entries: mapping " << time_map
+            << ", lists " << time_lists << " micro-seconds, memory "
+            << Matrix<T, Store>(mapping).memory_usage().dynamic / 1024 << " / "
+            << lists.memory_usage().dynamic / 1024 << " KB\n";
+
+  auto matrix = Matrix<T, Store>(mapping);
+  const auto x = _generate_random_vector<T>(n);
+  std::vector<T> y_map, y_lists;
+  timer.start();
+  for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y_map);
+  timer.stop();
+  double time_map_product = timer.wallTime() / num_runs;
+  timer.start();
+  for (std::size_t r = 0; r < num_runs; ++r) lists.multiply(x, y_lists);
+  timer.stop();
+  std::cout << "Uncompressed product: mapping " << time_map_product << ", lists "
+            << timer.wallTime() / num_runs << " micro-seconds, same result " << (y_map == y_lists)
+            << ", same norms "
+            << (matrix.template norm<NormOrder::one>() == lists.template norm<NormOrder::one>() &&
+                matrix.template norm<NormOrder::max>() == lists.template norm<NormOrder::max>())
+            << "\n";
+
+  timer.start();
+  matrix.compress();
+  timer.stop();
+  double time_map_compress = timer.wallTime();
+  timer.start();
+  const auto compressed = lists.compress();
+  timer.stop();
+  std::cout << "Compression: mapping " << time_map_compress << ", lists " << timer.wallTime()
+            << " micro-seconds, same products " << (matrix * x == compressed * x) << "\n";
+}
+
+// Test: uncompressed products of the file and of a generated 2D Poisson matrix
+// with num_points^2 rows in both storage orders. On the mapping of the user the
+// product walks the mapping. On an owned mapping (built from the compressed
+// vectors and uncompressed): the first product which builds the snapshot, the
+// following ones, ones after a read and a write of an existing entry through
+// the non-const operator(), which keep the snapshot, and one after a new entry.
+void benchmark_uncompressed_product(const std::string& file_name, std::size_t num_points,
+                                    std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto run = [&](const std::string& name, auto&& make) {
+    auto mapping_row = make.template operator()<StorageOrder::row>();
+    auto mapping_col = make.template operator()<StorageOrder::col>();
+    auto matrix_row = Matrix<T, StorageOrder::row>(mapping_row);
+    auto matrix_col = Matrix<T, StorageOrder::col>(mapping_col);
+    const std::size_t n = std::max(matrix_row.rows(), matrix_row.cols());
+    const auto x = _generate_random_vector<T>(n);
+    std::cout << name << "\n";
+
+    auto time = [&]<StorageOrder S>(Matrix<T, S>& matrix, const std::string& order) {
+      std::vector<T> y;
+      timer.start();
+      for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y);
+      timer.stop();
+      double time_user = timer.wallTime() / num_runs;
+      auto owned = matrix.coo().template to_matrix<S>();
+      owned.uncompress();
+      std::vector<T> res;
+      timer.start();
+      owned.multiply(x, res);
+      timer.stop();
+      double time_first = timer.wallTime();
+      bool same = res == y;
+      timer.start();
+      for (std::size_t r = 0; r < num_runs; ++r) owned.multiply(x, res);
+      timer.stop();
+      double time_repeated = timer.wallTime() / num_runs;
+      timer.start();
+      for (std::size_t r = 0; r < num_runs; ++r) {
+        static_cast<void>(owned(0, 0));
+        owned.multiply(x, res);
+      }
+      timer.stop();
+      double time_read = timer.wallTime() / num_runs;
+      const T diagonal = owned(0, 0);
+      owned(0, 0) = diagonal + 1;
+      owned.multiply(x, res);
+      // the write is seen by the product without a rebuild
+      same = same && std::abs(res[0] - y[0] - x[0]) <= 1e-8 * (1 + std::abs(y[0]));
+      owned(0, 0) = diagonal;
+      owned(owned.rows() - 1, 0) += 0;
+      timer.start();
+      owned.multiply(x, res);
+      timer.stop();
+      y.resize(res.size());
+      same = same && res == y;
+      std::cout << "  " << order << ": mapping of the user " << time_user << ", owned: first "
+                << time_first << ", repeated " << time_repeated << ", after a read " << time_read
+                << ", after a new entry " << timer.wallTime() << " micro-seconds, same result " << same << "\n";
+      return y;
+    };
+    const auto y_row = time(matrix_row, "row-major");
+    const auto y_col = time(matrix_col, "col-major");
+    std::cout << "  row- and col-major products equal " << (y_row == y_col) << "\n";
+  };
+  run(file_name, [&]<StorageOrder S>() { return read_matrix<T, S>(file_name); });
+  run("2D Poisson with " + std::to_string(num_points * num_points) + " rows",
+      [&]<StorageOrder S>() { return poisson_matrix<T, S>(num_points, 2); });
+}
+
+// Test: sessions mixing writes and read-only operations on the mapping of a
+// generated 2D Poisson matrix with num_points^2 rows, with the auto-compression
+// policy off and after each of num_reads read-only operations. Every cycle
+// updates the diagonal, runs num_runs products and a norm; in the second
+// session it also adds one new entry, which uncompresses the matrix.
+void benchmark_auto_compress(std::size_t num_points, const std::vector<std::size_t>& num_reads,
+                             std::size_t num_cycles, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  const std::size_t n = num_points * num_points;
+  const auto x = _generate_random_vector<T>(n);
+  for (bool new_entries : {false, true}) {
+    std::cout << (new_entries ? "Diagonal updates and a new entry per cycle\n" : "Diagonal updates\n");
+    std::vector<T> reference;
+    for (std::size_t threshold : num_reads) {
+      auto mapping = poisson_matrix<T, Store>(num_points, 2);
+      auto matrix = Matrix<T, Store>(mapping);
+      // the counters need the policy on, a threshold that is never reached keeps it from compressing
+      matrix.set_auto_compress(threshold == 0 ? std::numeric_limits<std::size_t>::max() : threshold);
+      std::vector<T> y;
+      timer.start();
+      for (std::size_t c = 0; c < num_cycles; ++c) {
+        for (std::size_t i = 0; i < n; ++i) matrix(i, i) += 1;
+        for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y);
+        matrix.template norm<NormOrder::frob>();
+        if (new_entries) matrix(c, n - 1 - c) = 1;
+      }
+      timer.stop();
+      if (reference.empty()) reference = y;
+      T max_err = 0;
+      for (std::size_t i = 0; i < n; ++i) max_err = std::max(max_err, std::abs(y[i] - reference[i]));
+      const auto counters = matrix.access_counters();
+      std::cout << "  policy " << (threshold == 0 ? std::string("off") : "after " + std::to_string(threshold) + " reads")
+                << ": " << timer.wallTime() / num_cycles << " micro-seconds per cycle, reads "
+                << counters.uncompressed_reads << " uncompressed / " << counters.compressed_reads
+                << " compressed, " << counters.writes << " writes, " << counters.auto_compressions
+                << " compressions, " << counters.auto_uncompressions << " uncompressions, max error "
+                << max_err << "\n";
+    }
+  }
+}
+// Test: element access and products on the compressed file and on a generated
+// 2D Poisson matrix with num_points^2 rows, with the debug checks compiled in
+// or not (make debug / make): reads of every stored entry through the const
+// operator(), writes through the non-const one, products, and validate().
+void benchmark_checks(const std::string& file_name, std::size_t num_points, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  std::cout << "Debug checks compiled in: " << _checked << "\n";
+  auto run = [&](const std::string& name, auto mapping) {
+    auto matrix = Matrix<T, Store>(mapping);
+    matrix.compress();
+    const Matrix<T, Store>& const_matrix = matrix;
+    std::vector<std::array<std::size_t, 2>> entries;
+    for (const auto& entry : matrix.nonzeros()) entries.push_back({entry.row, entry.col});
+    const auto x = _generate_random_vector<T>(matrix.cols());
+
+    T sum = 0;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r)
+      for (const auto& [i, j] : entries) sum += const_matrix(i, j);
+    timer.stop();
+    double time_read = timer.wallTime() / num_runs;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r)
+      for (const auto& [i, j] : entries) matrix(i, j) *= 1;
+    timer.stop();
+    double time_write = timer.wallTime() / num_runs;
+    std::vector<T> y;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y);
+    timer.stop();
+    double time_product = timer.wallTime() / num_runs;
+    timer.start();
+    matrix.validate();
+    timer.stop();
+    std::cout << name << " (" << entries.size() << " entries): reads " << time_read << ", writes "
+              << time_write << ", product " << time_product << ", validate " << timer.wallTime()
+              << " micro-seconds (checksum " << sum << ")\n";
+
+    // only caught with the checks, without them the access is undefined
+    if constexpr (_checked) {
+      try {
+        const_matrix(matrix.rows(), 0);
+      } catch (const std::out_of_range& e) {
+        std::cout << "  out of bounds read: " << e.what() << "\n";
+      }
+    }
+  };
+  run(file_name, read_matrix<T, Store>(file_name));
+  run("2D Poisson with " + std::to_string(num_points * num_points) + " rows",
+      poisson_matrix<T, Store>(num_points, 2));
+}
+
+// Test: products of the jagged diagonal storage against CSR, CSC and the
+// hybrid dense/sparse storage, on the matrix-market file, a generated 2D
+// Poisson matrix with num_points^2 rows and a generated matrix with size rows
+// of power-law lengths up to max_row_length.
+void benchmark_jagged_diagonal(const std::string& file_name, std::size_t num_points, std::size_t size,
+                               std::size_t max_row_length, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto run = [&](const std::string& name, auto&& make) {
+    auto row_mapping = make.template operator()<StorageOrder::row>();
+    auto col_mapping = make.template operator()<StorageOrder::col>();
+    auto csr = Matrix<T, StorageOrder::row>(row_mapping);
+    auto csc = Matrix<T, StorageOrder::col>(col_mapping);
+    csr.compress();
+    csc.compress();
+    const auto& matrix = [&]() -> const auto& {
+      if constexpr (Store == StorageOrder::row) return csr; else return csc;
+    }();
+    timer.start();
+    const JdsMatrix<T, Store> jds(matrix);
+    timer.stop();
+    double time_setup = timer.wallTime();
+    const DenseBlockMatrix<T, Store> hybrid(matrix);
+    const auto x = _generate_random_vector<T>(matrix.cols());
+
+    std::vector<T> y_ref, y;
+    auto time = [&](auto& format) {
+      format.multiply(x, y);
+      timer.start();
+      for (std::size_t r = 0; r < num_runs; ++r) format.multiply(x, y);
+      timer.stop();
+      T error = 0, scale = 0;
+      for (std::size_t i = 0; i < y_ref.size(); ++i) {
+        error = std::max(error, std::abs(y_ref[i] - y[i]));
+        scale = std::max(scale, std::abs(y_ref[i]));
+      }
+      std::cout << timer.wallTime() / num_runs << " (" << (y_ref.empty() ? T(0) : error / scale) << ")";
+      if (y_ref.empty()) y_ref = y;
+    };
+    std::cout << name << " (" << matrix.rows() << " rows, " << matrix.nnz() << " non-zeros, "
+              << jds.num_diagonals() << " jagged diagonals, setup " << time_setup << " micro-seconds)\n";
+    std::cout << "  product (max relative difference to CSR): CSR ";
+    time(csr);
+    std::cout << ", CSC ";
+    time(csc);
+    std::cout << ", hybrid ";
+    time(hybrid);
+    std::cout << ", JDS ";
+    time(jds);
+    std::cout << " micro-seconds\n";
+  };
+  run(file_name, [&]<StorageOrder S>() { return read_matrix<T, S>(file_name); });
+  run("2D Poisson with " + std::to_string(num_points * num_points) + " rows",
+      [&]<StorageOrder S>() { return poisson_matrix<T, S>(num_points, 2); });
+  run("Power-law rows up to " + std::to_string(max_row_length),
+      [&]<StorageOrder S>() { return power_law_matrix<T, S>(size, max_row_length); });
+}
+
+// Test: products of the CSR5 tiled view against the binned CSR product and the
+// jagged diagonal storage, on the matrix-market file, a generated 2D Poisson
+// matrix with num_points^2 rows and generated matrices with size rows of
+// power-law lengths (longest rows of the given lengths). The view works on the
+// CSR vectors, the matrices are always row-major.
+void benchmark_csr5(const std::string& file_name, std::size_t num_points, std::size_t size,
+                    const std::vector<std::size_t>& max_row_lengths, std::size_t num_runs) {
+  _print_test_case();
+  using RowMatrix = Matrix<T, StorageOrder::row>;
+  Timings::Chrono timer;
+  auto run = [&](const std::string& name, auto mapping) {
+    auto matrix = RowMatrix(mapping);
+    timer.start();
+    matrix.compress();
+    timer.stop();
+    double time_compress = timer.wallTime();
+    timer.start();
+    const auto csr5 = matrix.csr5();
+    timer.stop();
+    double time_csr5 = timer.wallTime();
+    const JdsMatrix<T, StorageOrder::row> jds(matrix);
+    const auto x = _generate_random_vector<T>(matrix.cols());
+
+    std::vector<T> y_ref, y;
+    auto time = [&](auto& format) {
+      format.multiply(x, y);
+      timer.start();
+      for (std::size_t r = 0; r < num_runs; ++r) format.multiply(x, y);
+      timer.stop();
+      T error = 0, scale = 0;
+      for (std::size_t i = 0; i < y_ref.size(); ++i) {
+        error = std::max(error, std::abs(y_ref[i] - y[i]));
+        scale = std::max(scale, std::abs(y_ref[i]));
+      }
+      std::cout << timer.wallTime() / num_runs << " (" << (y_ref.empty() ? T(0) : error / scale) << ")";
+      if (y_ref.empty()) y_ref = y;
+    };
+    std::cout << name << " (" << matrix.rows() << " rows, " << matrix.nnz() << " non-zeros): "
+              << csr5.num_tiles() << " tiles, descriptors " << time_csr5 << " micro-seconds (compress "
+              << time_compress << ")\n";
+    std::cout << "  product (max relative difference to CSR): CSR ";
+    time(matrix);
+    std::cout << ", JDS ";
+    time(jds);
+    std::cout << ", CSR5 ";
+    time(csr5);
+    std::cout << " micro-seconds\n";
+  };
+  run(file_name, read_matrix<T, StorageOrder::row>(file_name));
+  run("2D Poisson with " + std::to_string(num_points * num_points) + " rows",
+      poisson_matrix<T, StorageOrder::row>(num_points, 2));
+  for (auto max_row_length : max_row_lengths)
+    run("Power-law rows up to " + std::to_string(max_row_length),
+        power_law_matrix<T, StorageOrder::row>(size, max_row_length));
+}
+
+// Test: alternating products with A and A^T, as in adjoint methods, on the
+// matrix-market file and on a generated 2D Poisson matrix with num_points^2
+// rows: with a row-major copy only (A^T x scattered into per-thread copies of
+// y), with a row-major and a col-major copy (A^T x gathered over the columns),
+// and with the CSB storage.
+void benchmark_csb(const std::string& file_name, std::size_t num_points, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto run = [&](const std::string& name, auto&& make) {
+    auto row_mapping = make.template operator()<StorageOrder::row>();
+    auto col_mapping = make.template operator()<StorageOrder::col>();
+    auto csr = Matrix<T, StorageOrder::row>(row_mapping);
+    auto csc = Matrix<T, StorageOrder::col>(col_mapping);
+    csr.compress();
+    csc.compress();
+    const auto& matrix = [&]() -> const auto& {
+      if constexpr (Store == StorageOrder::row) return csr; else return csc;
+    }();
+    timer.start();
+    const CsbMatrix<T, Store> csb(matrix);
+    timer.stop();
+    double time_setup = timer.wallTime();
+    const std::size_t n_rows = csr.rows(), n_cols = csr.cols();
+    const auto x = _generate_random_vector<T>(n_cols), z = _generate_random_vector<T>(n_rows);
+
+    // A x on the CSR copy, A^T z scattered from its rows
+    std::vector<T> y_csr, w_csr(n_cols);
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) {
+      csr.multiply(x, y_csr);
+      std::fill(w_csr.begin(), w_csr.end(), 0);
+      T* w = w_csr.data();
+#pragma omp parallel for schedule(static) reduction(+ : w[:n_cols])
+      for (std::size_t i = 0; i < n_rows; ++i) {
+        const auto row = csr.row(i);
+        for (std::size_t k = 0; k < row.size(); ++k) w[row.indices[k]] += row.values[k] * z[i];
+      }
+    }
+    timer.stop();
+    double time_csr = timer.wallTime() / num_runs;
+    // A^T z gathered over the columns of the CSC copy
+    std::vector<T> w_both(n_cols);
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) {
+      csr.multiply(x, y_csr);
+#pragma omp parallel for schedule(static)
+      for (std::size_t j = 0; j < n_cols; ++j) {
+        const auto col = csc.col(j);
+        T sum = 0;
+        for (std::size_t k = 0; k < col.size(); ++k) sum += col.values[k] * z[col.indices[k]];
+        w_both[j] = sum;
+      }
+    }
+    timer.stop();
+    double time_both = timer.wallTime() / num_runs;
+    std::vector<T> y_csb, w_csb;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) csb.multiply(x, y_csb);
+    timer.stop();
+    double time_csb_ax = timer.wallTime() / num_runs;
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) csb.multiply_transpose(z, w_csb);
+    timer.stop();
+    double time_csb_atx = timer.wallTime() / num_runs;
+
+    T error = 0, scale = 0;
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      error = std::max(error, std::abs(y_csr[i] - y_csb[i]));
+      scale = std::max(scale, std::abs(y_csr[i]));
+    }
+    for (std::size_t j = 0; j < n_cols; ++j) {
+      error = std::max({error, std::abs(w_both[j] - w_csb[j]), std::abs(w_csr[j] - w_csb[j])});
+      scale = std::max(scale, std::abs(w_both[j]));
+    }
+    std::cout << name << " (" << csr.nnz() << " non-zeros): blocks of size " << csb.block_size()
+              << ", setup " << time_setup << " micro-seconds\n";
+    std::cout << "  A x + A^T x: row copy " << time_csr << ", row and col copies " << time_both
+              << ", CSB " << time_csb_ax + time_csb_atx << " (A x " << time_csb_ax << ", A^T x "
+              << time_csb_atx << ") micro-seconds, max relative difference " << error / scale << "\n";
+    std::cout << "  memory: row copy " << csr.memory_usage().total() / 1024 << ", both copies "
+              << (csr.memory_usage().total() + csc.memory_usage().total()) / 1024 << ", CSB "
+              << csb.memory_usage().total() / 1024 << " KB\n";
+  };
+  run(file_name, [&]<StorageOrder S>() { return read_matrix<T, S>(file_name); });
+  run("2D Poisson with " + std::to_string(num_points * num_points) + " rows",
+      [&]<StorageOrder S>() { return poisson_matrix<T, S>(num_points, 2); });
+}
+
+// Test: quadtree storage on the multi-scale pattern of an adaptively refined
+// mesh, a generated 2D Poisson matrix with num_points^2 rows plus num_levels
+// levels of dense patches of patch_size / 2^l rows: construction from the
+// mapping against compress(), leaf statistics, A x and A A against the
+// compressed matrix for several leaf sizes. A A is checked through (A A) x
+// against A (A x), and so are the products of trees with different padded
+// sizes, A [A A A] and [A; A; A] A.
+void benchmark_quadtree(std::size_t num_points, std::size_t patch_size, std::size_t num_levels,
+                        std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  const auto mapping = refined_matrix<T, Store>(num_points, patch_size, num_levels);
+  // compress empties the mapping it is given, the trees are built from the original
+  auto matrix_mapping = mapping;
+  auto matrix = Matrix<T, Store>(matrix_mapping);
+  timer.start();
+  matrix.compress();
+  timer.stop();
+  double time_compress = timer.wallTime();
+  const std::size_t n = matrix.rows();
+  const auto x = _generate_random_vector<T>(n);
+  std::vector<T> y_matrix, y_tree;
+  matrix.multiply(x, y_matrix);
+  timer.start();
+  for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y_matrix);
+  timer.stop();
+  double time_matrix = timer.wallTime() / num_runs;
+  timer.start();
+  const auto square = matrix * matrix;
+  timer.stop();
+  double time_matrix_square = timer.wallTime();
+  std::cout << n << " rows, " << matrix.nnz() << " non-zeros, " << num_levels
+            << " levels of refinement: compress " << time_compress << ", A x " << time_matrix
+            << ", A A " << time_matrix_square << " micro-seconds\n";
+
+  for (const std::size_t leaf_size : {32, 64, 128}) {
+    timer.start();
+    const QuadTreeMatrix<T, Store> tree(mapping, leaf_size);
+    timer.stop();
+    double time_setup = timer.wallTime();
+    tree.multiply(x, y_tree);
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) tree.multiply(x, y_tree);
+    timer.stop();
+    double time_tree = timer.wallTime() / num_runs;
+    timer.start();
+    const auto tree_square = tree * tree;
+    timer.stop();
+    double time_tree_square = timer.wallTime();
+
+    T error = 0, scale = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      error = std::max(error, std::abs(y_matrix[i] - y_tree[i]));
+      scale = std::max(scale, std::abs(y_matrix[i]));
+    }
+    // (A A) x against A (A x) for the tree, and against the compressed product
+    const auto y_square = tree_square * x, y_twice = tree * (tree * x), y_reference = square * x;
+    T error_square = 0, scale_square = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      error_square = std::max({error_square, std::abs(y_square[i] - y_twice[i]),
+                               std::abs(y_square[i] - y_reference[i])});
+      scale_square = std::max(scale_square, std::abs(y_twice[i]));
+    }
+    std::cout << "leaves of size " << leaf_size << ": " << tree.num_dense_leaves() << " dense, "
+              << tree.num_sparse_leaves() << " sparse, setup " << time_setup << " micro-seconds\n";
+    std::cout << "  A x " << time_tree << ", A A " << time_tree_square << " ("
+              << tree_square.nnz() << " non-zeros against " << square.nnz()
+              << ") micro-seconds, max relative difference " << error / scale << " and "
+              << error_square / scale_square << "\n";
+    std::cout << "  memory: compressed " << matrix.memory_usage().compressed / 1024 << ", quadtree "
+              << tree.memory_usage().total() / 1024 << " KB\n";
+  }
+
+  // the wide and the tall matrix are padded to a larger size than A
+  typename Matrix<T, Store>::matrix_type wide_mapping, tall_mapping;
+  for (const auto& [k, v] : mapping)
+    for (std::size_t c = 0; c < 3; ++c) {
+      wide_mapping[{k[0], k[1] + c * n}] = v;
+      tall_mapping[{k[0] + c * n, k[1]}] = v;
+    }
+  const QuadTreeMatrix<T, Store> tree(mapping), wide(wide_mapping), tall(tall_mapping);
+  const auto z = _generate_random_vector<T>(3 * n);
+  timer.start();
+  const auto tree_wide = tree * wide;
+  timer.stop();
+  double time_wide = timer.wallTime();
+  timer.start();
+  const auto tall_tree = tall * tree;
+  timer.stop();
+  double time_tall = timer.wallTime();
+  const auto y_wide = tree_wide * z, y_wide_twice = tree * (wide * z);
+  const auto y_tall = tall_tree * x, y_tall_twice = tall * (tree * x);
+  T error = 0, scale = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    error = std::max(error, std::abs(y_wide[i] - y_wide_twice[i]));
+    scale = std::max(scale, std::abs(y_wide_twice[i]));
+  }
+  for (std::size_t i = 0; i < 3 * n; ++i) {
+    error = std::max(error, std::abs(y_tall[i] - y_tall_twice[i]));
+    scale = std::max(scale, std::abs(y_tall_twice[i]));
+  }
+  std::cout << "A [A A A] " << time_wide << ", [A; A; A] A " << time_tall
+            << " micro-seconds, max relative difference " << error / scale << "\n";
+}
+
+// Test: COO storage on the matrix-market file, a generated 2D Poisson matrix
+// with num_points^2 rows and a generated matrix with size rows of power-law
+// lengths up to max_row_length: triplets from the uncompressed and from the
+// compressed state against compress(), conversions back to CSR and CSC, and
+// the product against the compressed matrix.
+void benchmark_coo(const std::string& file_name, std::size_t num_points, std::size_t size,
+                   std::size_t max_row_length, std::size_t num_runs) {
+  _print_test_case();
+  Timings::Chrono timer;
+  auto run = [&](const std::string& name, auto&& mapping) {
+    auto matrix = Matrix<T, Store>(mapping);
+    timer.start();
+    const auto coo_map = matrix.coo();
+    timer.stop();
+    double time_from_map = timer.wallTime();
+    timer.start();
+    matrix.compress();
+    timer.stop();
+    double time_compress = timer.wallTime();
+    timer.start();
+    const auto coo = matrix.coo();
+    timer.stop();
+    double time_from_compressed = timer.wallTime();
+    timer.start();
+    const auto csr = coo.template to_matrix<StorageOrder::row>();
+    timer.stop();
+    double time_to_csr = timer.wallTime();
+    timer.start();
+    const auto csc = coo.template to_matrix<StorageOrder::col>();
+    timer.stop();
+    double time_to_csc = timer.wallTime();
+
+    const auto x = _generate_random_vector<T>(matrix.cols());
+    std::vector<T> y_matrix, y_coo;
+    matrix.multiply(x, y_matrix);
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) matrix.multiply(x, y_matrix);
+    timer.stop();
+    double time_matrix = timer.wallTime() / num_runs;
+    coo.multiply(x, y_coo);
+    timer.start();
+    for (std::size_t r = 0; r < num_runs; ++r) coo.multiply(x, y_coo);
+    timer.stop();
+    double time_coo = timer.wallTime() / num_runs;
+
+    // the conversions and the triplets of both states must give the same products
+    const auto y_csr = csr * x, y_csc = csc * x, y_map = coo_map * x;
+    T error = 0, scale = 0;
+    for (std::size_t i = 0; i < y_matrix.size(); ++i) {
+      error = std::max({error, std::abs(y_matrix[i] - y_coo[i]), std::abs(y_matrix[i] - y_csr[i]),
+                        std::abs(y_matrix[i] - y_csc[i]), std::abs(y_matrix[i] - y_map[i])});
+      scale = std::max(scale, std::abs(y_matrix[i]));
+    }
+    std::cout << name << " (" << matrix.nnz() << " non-zeros): COO from the mapping " << time_from_map
+              << ", compress " << time_compress << ", COO from compressed " << time_from_compressed
+              << ", to CSR " << time_to_csr << ", to CSC " << time_to_csc << " micro-seconds\n";
+    std::cout << "  product: compressed " << time_matrix << ", COO " << time_coo
+              << " micro-seconds, max relative difference " << error / scale << "\n";
+    std::cout << "  memory: compressed " << matrix.memory_usage().compressed / 1024 << ", COO "
+              << coo.memory_usage().total() / 1024 << " KB\n";
+  };
+  run(file_name, read_matrix<T, Store>(file_name));
+  run("2D Poisson with " + std::to_string(num_points * num_points) + " rows",
+      poisson_matrix<T, Store>(num_points, 2));
+  run("Power-law rows up to " + std::to_string(max_row_length), power_law_matrix<T, Store>(size, max_row_length));
+}
+
 }; // class Benchmark
 
 } // namespace algebra
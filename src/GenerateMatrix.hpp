@@ -0,0 +1,180 @@
+#ifndef GENERATE_MATRIX_HPP
+#define GENERATE_MATRIX_HPP
+// clang-format off
+#include <algorithm>
+#include <array>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "Utilities.hpp"
+
+namespace algebra {
+
+/**
+ * @brief Generate the finite difference Laplacian on a structured grid with num_points points per
+ * direction and homogeneous Dirichlet conditions, i.e. the 3/5/7-point stencil with 2*dim on the
+ * diagonal and -1 for every neighbour. The matrix is symmetric positive definite of size
+ * num_points^dim, the usual model problem for large sparse benchmarks.
+ *
+ * @tparam T Type of the matrix entries.
+ * @tparam Store StorageOrder for the matrix, deciding the ordering of the mapping.
+ * @param num_points Number of grid points per direction.
+ * @param dim Space dimension, 1, 2 or 3.
+ * @return Mapping "(row, col) -> value" which can be directly passed into the constructor.
+ */
+template <Numeric T, StorageOrder Store>
+std::map<std::array<std::size_t, 2>, T,
+         std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>,
+                            ColOrderComparator<T>>>
+poisson_matrix(std::size_t num_points, std::size_t dim) {
+  using mapping_type = std::map<
+      std::array<std::size_t, 2>, T,
+      std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>,
+                         ColOrderComparator<T>>>;
+  if (dim < 1 || dim > 3) {
+    throw std::invalid_argument("Only 1, 2 and 3 dimensional grids are supported");
+  }
+  const std::size_t nx = num_points;
+  const std::size_t ny = dim > 1 ? num_points : 1;
+  const std::size_t nz = dim > 2 ? num_points : 1;
+
+  mapping_type entry_value_map;
+  // lexicographic numbering, x runs fastest
+  for (std::size_t k = 0; k < nz; ++k) {
+    for (std::size_t j = 0; j < ny; ++j) {
+      for (std::size_t i = 0; i < nx; ++i) {
+        const std::size_t row = i + nx * (j + ny * k);
+        entry_value_map[{row, row}] = static_cast<T>(2 * dim);
+        if (i > 0) entry_value_map[{row, row - 1}] = -1;
+        if (i + 1 < nx) entry_value_map[{row, row + 1}] = -1;
+        if (j > 0) entry_value_map[{row, row - nx}] = -1;
+        if (j + 1 < ny) entry_value_map[{row, row + nx}] = -1;
+        if (k > 0) entry_value_map[{row, row - nx * ny}] = -1;
+        if (k + 1 < nz) entry_value_map[{row, row + nx * ny}] = -1;
+      }
+    }
+  }
+  return entry_value_map;
+}
+/**
+ * @brief Generate the 2D Poisson matrix on a num_points x num_points grid with num_blocks dense
+ * blocks of size block_size x block_size added at random positions, like the coupling of a mesh
+ * to lumped models. The block entries are small random values, the positions are drawn with a
+ * fixed seed.
+ *
+ * @tparam T Type of the matrix entries.
+ * @tparam Store StorageOrder for the matrix, deciding the ordering of the mapping.
+ * @param num_points Number of grid points per direction.
+ * @param num_blocks Number of dense blocks.
+ * @param block_size Size of the dense blocks.
+ * @return Mapping "(row, col) -> value" which can be directly passed into the constructor.
+ */
+template <Numeric T, StorageOrder Store>
+std::map<std::array<std::size_t, 2>, T,
+         std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>,
+                            ColOrderComparator<T>>>
+dense_block_matrix(std::size_t num_points, std::size_t num_blocks, std::size_t block_size) {
+  auto entry_value_map = poisson_matrix<T, Store>(num_points, 2);
+  const std::size_t n = num_points * num_points;
+  if (block_size > n) {
+    throw std::invalid_argument("The dense blocks do not fit into the matrix");
+  }
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<std::size_t> position(0, n - block_size);
+  std::uniform_real_distribution<T> value(-0.01, 0.01);
+  for (std::size_t b = 0; b < num_blocks; ++b) {
+    const std::size_t first_row = position(gen), first_col = position(gen);
+    for (std::size_t i = 0; i < block_size; ++i)
+      for (std::size_t j = 0; j < block_size; ++j)
+        entry_value_map[{first_row + i, first_col + j}] += value(gen);
+  }
+  return entry_value_map;
+}
+/**
+ * @brief Generate a square matrix with skewed (power-law) row lengths: the rows get the ranks
+ * 1..size in random order, the row of rank r has max_row_length / r random off-diagonal entries
+ * (at least one) plus the diagonal. Most rows are very short and a few are very long, like in
+ * graphs with hub vertices. Drawn with a fixed seed.
+ *
+ * @tparam T Type of the matrix entries.
+ * @tparam Store StorageOrder for the matrix, deciding the ordering of the mapping.
+ * @param size Number of rows and columns.
+ * @param max_row_length Number of off-diagonal entries of the longest row, at most size - 1.
+ * @return Mapping "(row, col) -> value" which can be directly passed into the constructor.
+ */
+template <Numeric T, StorageOrder Store>
+std::map<std::array<std::size_t, 2>, T,
+         std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>,
+                            ColOrderComparator<T>>>
+power_law_matrix(std::size_t size, std::size_t max_row_length) {
+  using mapping_type = std::map<
+      std::array<std::size_t, 2>, T,
+      std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>,
+                         ColOrderComparator<T>>>;
+  if (size < 2 || max_row_length >= size) {
+    throw std::invalid_argument("The longest row does not fit into the matrix");
+  }
+  std::mt19937 gen(42);
+  std::vector<std::size_t> rank(size);
+  for (std::size_t i = 0; i < size; ++i) rank[i] = i + 1;
+  std::shuffle(rank.begin(), rank.end(), gen);
+  std::uniform_int_distribution<std::size_t> column(0, size - 1);
+  std::uniform_real_distribution<T> value(-1, 1);
+
+  mapping_type entry_value_map;
+  for (std::size_t i = 0; i < size; ++i) {
+    entry_value_map[{i, i}] = 2 * max_row_length;
+    const std::size_t length = std::max<std::size_t>(1, max_row_length / rank[i]);
+    for (std::size_t k = 0; k < length;) {
+      const std::size_t j = column(gen);
+      if (j == i || entry_value_map.count({i, j})) continue;
+      entry_value_map[{i, j}] = value(gen);
+      ++k;
+    }
+  }
+  return entry_value_map;
+}
+/**
+ * @brief Generate a matrix with the multi-scale pattern of an adaptively refined mesh: the 2D
+ * Poisson matrix on a num_points x num_points grid, plus num_levels levels of refined patches.
+ * Level l has 2^l patches of patch_size / 2^l consecutive rows at random positions, in which every
+ * row is coupled to all rows closer than a quarter of the patch size, so that the pattern is dense
+ * inside the patches and sparse around them. The patch entries are small random values, the
+ * positions are drawn with a fixed seed.
+ *
+ * @tparam T Type of the matrix entries.
+ * @tparam Store StorageOrder for the matrix, deciding the ordering of the mapping.
+ * @param num_points Number of grid points per direction.
+ * @param patch_size Number of rows of the patches of the coarsest level.
+ * @param num_levels Number of levels of refinement.
+ * @return Mapping "(row, col) -> value" which can be directly passed into the constructor.
+ */
+template <Numeric T, StorageOrder Store>
+std::map<std::array<std::size_t, 2>, T,
+         std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>,
+                            ColOrderComparator<T>>>
+refined_matrix(std::size_t num_points, std::size_t patch_size, std::size_t num_levels) {
+  auto entry_value_map = poisson_matrix<T, Store>(num_points, 2);
+  const std::size_t n = num_points * num_points;
+  if (patch_size > n) {
+    throw std::invalid_argument("The patches do not fit into the matrix");
+  }
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<T> value(-0.01, 0.01);
+  for (std::size_t l = 0; l < num_levels; ++l) {
+    const std::size_t size = patch_size >> l, width = std::max<std::size_t>(1, size / 4);
+    std::uniform_int_distribution<std::size_t> position(0, n - size);
+    for (std::size_t p = 0; p < (std::size_t(1) << l); ++p) {
+      const std::size_t first = position(gen);
+      for (std::size_t i = 0; i < size; ++i)
+        for (std::size_t j = i > width ? i - width + 1 : 0; j < std::min(size, i + width); ++j)
+          entry_value_map[{first + i, first + j}] += value(gen);
+    }
+  }
+  return entry_value_map;
+}
+}  // namespace algebra
+
+#endif
@@ -2,17 +2,64 @@
 #define MATRIX_SPARSE_HPP
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cmath>
 #include <complex>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <shared_mutex>
+#include <span>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 #include <vector>
 // clang-format off
 #include "Utilities.hpp"
 
 namespace algebra {
 
+// adjacency structure of the sparsity pattern, defined in partition.hpp
+struct PatternGraph;
+
+// zero-copy view of a contiguous range of rows/cols, defined in submatrix.hpp
+template <Numeric T, StorageOrder Store> class MatrixSlice;
+
+// views and iterators over the non-zeros, defined in iterators.hpp
+template <typename V> struct SparseVectorView;
+template <Numeric T, StorageOrder Store> class NonZeroIterator;
+
+// dense diagonal blocks for block-Jacobi, defined in block_jacobi.hpp
+template <Numeric T> class BlockDiagonal;
+
+// tiled view of a CSR matrix, defined in csr5.hpp
+template <Numeric T> class Csr5Matrix;
+
+// coordinate storage of the triplets, defined in coo.hpp
+template <Numeric T, StorageOrder Store> class CooMatrix;
+
+// bytes held by a matrix, defined in memory.hpp
+struct MemoryUsage;
+
+// counters of the auto-compression policy, defined in auto_compress.hpp
+struct AccessCounters;
+
+// checks of the indices and of the compressed structure, compiled in with
+// -DDEBUG (make debug) and stripped otherwise, see checks.hpp
+#ifdef DEBUG
+inline constexpr bool _checked = true;
+#else
+inline constexpr bool _checked = false;
+#endif
+
 /**
  * @brief Class representing a sparse matrix, which can be stored in row or
  * column major format. The matrix can be compressed into a compressed sparse
@@ -150,38 +197,16 @@ private:
   /**
    * @brief Matrix-vector product in the uncompressed state. This type of
    * multiplication is not the most efficent, maybe better first to compress and
-   * then use the compressed multiplication
+   * then use the compressed multiplication. On an owned mapping it runs on a
+   * row-wise snapshot, rebuilt only when an entry was added, on a mapping of
+   * the user it walks the mapping, see snapshot.hpp.
    *
    * @param vec Vector x to multiply on the right side.
    * @return std::vector<T> Vector y = A*x.
    */
-  std::vector<T> _uncompressed_mult(std::vector<T> vect) const {
-    //@note You think to have initialized num_rows, but you have not! Why you do
-    //not read the compiler warnings?
-    // To initialize both variables you can use the following syntax
-    // std::size_t num_rows = 0;
-    // std::size_t num_cols = 0;
-    std::size_t num_rows, num_cols = 0; // @note this is not initializing num_rows ERROR!
-    if constexpr (Store == StorageOrder::row) {
-
-      num_rows = _entry_value_map.rbegin()->first[0];
-      num_cols = _entry_value_map.rbegin()->first[1];
-    } else {
-      for (const auto &[k, v] : _entry_value_map) {
-        num_rows = std::max(num_rows, k[0]);
-        num_cols = std::max(num_cols, k[1]);
-      }
-    }
-
-    // std::cout << "num cols = " << num_cols << "\n";
-    std::vector<T> res(
-        num_rows + 1,
-        0); // should be +1 since the rows starts from 0 @note WHY??????
-
-    for (const auto &[k, v] : _entry_value_map) {
-
-      res[k[0]] += (vect[k[1]] * v);
-    }
+  std::vector<T> _uncompressed_mult(const std::vector<T> &vect) const {
+    std::vector<T> res;
+    _multiply_snapshot(vect, res);
     return res;
   }
 
@@ -205,14 +230,99 @@ private:
   T _one_norm_compressed_col() const;
   T _max_norm_compressed_col() const;
 
+  // helpers for the graph partitioning, see partition.hpp
+  PatternGraph _pattern_graph() const;
+
+  // helper for row()/col(), see iterators.hpp
+  SparseVectorView<const T> _compressed_vector_view(std::size_t o) const;
+
+  // helper for the matrix-matrix product, see products.hpp
+  Matrix _multiply_matrix(const Matrix &right) const;
+
+  // helpers for the Kronecker product and sum, see kronecker.hpp
+  Matrix _kronecker_product(const Matrix &right) const;
+  Matrix _kronecker_sum(const Matrix &right) const;
+
+  // rows binned by length for the CSR matrix-vector product, see row_bins.hpp
+  void _bin_rows();
+  void _multiply_binned(const std::vector<T> &vec, std::vector<T> &res) const;
+
+  // row-wise snapshot of the mapping for the uncompressed product, see
+  // snapshot.hpp
+  void _build_snapshot() const;
+  void _drop_snapshot();
+  void _multiply_snapshot(const std::vector<T> &vec, std::vector<T> &res) const;
+
+  // debug checks of the indices and vector sizes, see checks.hpp
+  void _check_access(std::size_t row, std::size_t col) const;
+  void _check_vector(const std::vector<T> &vec) const;
+
+  // auto-compression policy, see auto_compress.hpp
+  bool _is_stored(std::size_t row, std::size_t col) const;
+  void _count_read() const;
+  void _count_write(std::size_t row, std::size_t col);
+  void _apply_auto_compress();
+
+  // deterministic CSC matrix-vector product, see reproducible.hpp
+  void _build_gather_index() const;
+  void _multiply_ordered(const std::vector<T> &vec, std::vector<T> &res) const;
+
+  // size of the inner dimension to be inferred from the inner indices
+  static constexpr std::size_t _unknown_size =
+      std::numeric_limits<std::size_t>::max();
+
   // class attributes
   bool _is_compressed;
+  // mapping owned by the matrix, used when it is built directly from the
+  // compressed vectors so that uncompress() has somewhere to write to
+  matrix_type _own_entry_value_map;
   matrix_type &_entry_value_map;
 
   // internal representations of the values for the compressed formats
   std::vector<std::size_t> _inner;
   std::vector<std::size_t> _outer;
   std::vector<T> _values;
+  // size of the dimension indexed by _outer (#cols for CSR, #rows for CSC),
+  // stored at compression so that rows()/cols() do not scan _outer
+  std::size_t _num_inner = 0;
+  // CSR only, filled at compression: the rows of bin b (short, medium, long)
+  // are _row_perm[_bin_ptr[b], _bin_ptr[b + 1]), the long rows are split into
+  // the entry ranges _row_chunks[_chunk_ptr[k], _chunk_ptr[k + 1]), see
+  // row_bins.hpp
+  std::vector<std::size_t> _row_perm;
+  std::array<std::size_t, 4> _bin_ptr{};
+  std::vector<std::size_t> _chunk_ptr;
+  std::vector<std::array<std::size_t, 2>> _row_chunks;
+  // CSC only, row-wise index of the entries built on the first deterministic
+  // product, see reproducible.hpp
+  mutable std::vector<std::size_t> _gather_inner;
+  mutable std::vector<std::size_t> _gather_outer;
+  mutable std::vector<std::size_t> _gather_pos;
+  // const products share the gather index, the first one builds it holding
+  // the lock exclusively
+  mutable std::shared_mutex _gather_mutex;
+  // uncompressed state with an owned mapping only, pattern of the mapping
+  // sorted by rows with pointers to its values and the number of columns,
+  // valid while the size of the mapping is the same, see snapshot.hpp
+  mutable std::vector<std::size_t> _snapshot_inner;
+  mutable std::vector<std::size_t> _snapshot_outer;
+  mutable std::vector<const T *> _snapshot_values;
+  mutable std::size_t _snapshot_cols = 0;
+  mutable std::size_t _snapshot_size = 0;
+  mutable bool _snapshot_valid = false;
+  // const products share the snapshot, the one which rebuilds it holds the
+  // lock exclusively
+  mutable std::shared_mutex _snapshot_mutex;
+  // number of consecutive read-only operations after which the matrix
+  // compresses itself, 0 if the policy is off; the counters are only updated
+  // with the policy on, see auto_compress.hpp
+  std::size_t _auto_compress = 0;
+  mutable std::atomic<std::size_t> _consecutive_reads = 0;
+  mutable std::atomic<std::size_t> _uncompressed_reads = 0;
+  mutable std::atomic<std::size_t> _compressed_reads = 0;
+  std::atomic<std::size_t> _writes = 0;
+  std::atomic<std::size_t> _auto_compressions = 0;
+  std::atomic<std::size_t> _auto_uncompressions = 0;
 
 public:
   /**
@@ -241,8 +351,74 @@ public:
    */
   Matrix(std::vector<std::size_t> vec1, std::vector<std::size_t> vec2,
          std::vector<T> values)
-      : _is_compressed(true), _entry_value_map(), _inner(vec1), _outer(vec2),
-        _values(values){};
+      : Matrix(std::move(vec1), std::move(vec2), std::move(values),
+               _unknown_size){};
+
+  /**
+   * @brief Construct a new Matrix object, based on a compressed format with
+   * the size of the inner dimension given, so that empty last columns (CSR) or
+   * rows (CSC) are kept. Used by all the operations which build a compressed
+   * matrix from vectors.
+   *
+   * @param vec1 Outer pointers, see above.
+   * @param vec2 Inner indices, see above.
+   * @param values Values.
+   * @param num_inner Number of columns (CSR) or rows (CSC), inferred from the
+   * largest inner index if _unknown_size.
+   */
+  Matrix(std::vector<std::size_t> vec1, std::vector<std::size_t> vec2,
+         std::vector<T> values, std::size_t num_inner)
+      : _is_compressed(true), _own_entry_value_map(),
+        _entry_value_map(_own_entry_value_map), _inner(std::move(vec1)),
+        _outer(std::move(vec2)), _values(std::move(values)),
+        _num_inner(num_inner) {
+    const std::size_t min_inner =
+        _outer.empty() ? 0 : *max_element(_outer.begin(), _outer.end()) + 1;
+    if (_num_inner == _unknown_size) {
+      _num_inner = min_inner;
+    } else if (_num_inner < min_inner) {
+      throw std::invalid_argument(
+          "The inner indices exceed the size of the inner dimension");
+    }
+    if constexpr (_checked)
+      validate();
+    if constexpr (Store == StorageOrder::row) {
+      _bin_rows();
+    }
+  };
+
+  /**
+   * @brief Copy constructor. The copy shares the user mapping as before, but
+   * if the source owns its mapping the copy gets its own one.
+   *
+   * @param other Matrix to copy.
+   */
+  Matrix(const Matrix &other)
+      : _is_compressed(other._is_compressed),
+        _own_entry_value_map(other._own_entry_value_map),
+        _entry_value_map(other._owns_mapping() ? _own_entry_value_map
+                                               : other._entry_value_map),
+        _inner(other._inner), _outer(other._outer), _values(other._values),
+        _num_inner(other._num_inner), _row_perm(other._row_perm),
+        _bin_ptr(other._bin_ptr), _chunk_ptr(other._chunk_ptr),
+        _row_chunks(other._row_chunks), _auto_compress(other._auto_compress){};
+
+  /**
+   * @brief Move constructor, same rule for the mapping as the copy.
+   *
+   * @param other Matrix to move from.
+   */
+  Matrix(Matrix &&other)
+      : _is_compressed(other._is_compressed),
+        _own_entry_value_map(std::move(other._own_entry_value_map)),
+        _entry_value_map(other._owns_mapping() ? _own_entry_value_map
+                                               : other._entry_value_map),
+        _inner(std::move(other._inner)), _outer(std::move(other._outer)),
+        _values(std::move(other._values)), _num_inner(other._num_inner),
+        _row_perm(std::move(other._row_perm)), _bin_ptr(other._bin_ptr),
+        _chunk_ptr(std::move(other._chunk_ptr)),
+        _row_chunks(std::move(other._row_chunks)),
+        _auto_compress(other._auto_compress){};
 
   //@note Normally you want also a constructor that takes the number of rows and
   // columns and a method to fill the matrix
@@ -255,6 +431,7 @@ public:
    * @return T norm of the matrix
    */
   template <NormOrder Norm> T norm() const {
+    _count_read();
 
     // FROB norm is the easiest case
     //@note very involved, some of the selections could have been made at the
@@ -293,8 +470,14 @@ public:
    * @return T& Entry of the matrix.
    */
   T &operator()(std::size_t row, std::size_t col) {
-
+    if constexpr (_checked)
+      _check_access(row, col);
+    // with the auto-compression policy a new entry uncompresses the matrix
+    if (_auto_compress != 0)
+      _count_write(row, col);
     if (!_is_compressed) { // so is the dynamic storage case
+      // the snapshot points to the values, a new entry changes the size of the
+      // mapping and triggers its rebuild, see snapshot.hpp
       std::array<std::size_t, 2> find = {row, col};
       // either add or override, both is fine
       return _entry_value_map[find];
@@ -318,6 +501,8 @@ public:
    * @return T Value of the matrix entry.
    */
   T operator()(std::size_t row, std::size_t col) const {
+    if constexpr (_checked)
+      _check_access(row, col);
 
     if (!_is_compressed) {
       return this->_find_uncompressed_element(row, col);
@@ -335,8 +520,11 @@ public:
    * @param vec Vector x to multiply from the right-hand side.
    * @return std::vector<T> Output vector y, i.e. y = Ax.
    */
-  friend std::vector<T> operator*(const Matrix<T, Store> matrix,
-                                  std::vector<T> vec) {
+  friend std::vector<T> operator*(const Matrix<T, Store> &matrix,
+                                  const std::vector<T> &vec) {
+    matrix._count_read();
+    if constexpr (_checked)
+      matrix._check_vector(vec);
     if (!matrix._is_compressed) {
       return matrix._uncompressed_mult(vec);
     }
@@ -348,6 +536,58 @@ public:
     return matrix._matrix_vector_col(vec);
   };
 
+  /**
+   * @brief Matrix-vector product of a non-const matrix, which applies the
+   * auto-compression policy first, see auto_compress.hpp.
+   *
+   * @param vec Vector x to multiply from the right-hand side.
+   * @return std::vector<T> Output vector y, i.e. y = Ax.
+   */
+  friend std::vector<T> operator*(Matrix<T, Store> &matrix,
+                                  const std::vector<T> &vec) {
+    matrix._apply_auto_compress();
+    return std::as_const(matrix) * vec;
+  };
+
+  /**
+   * @brief Compute the matrix-matrix product, both matrices have to be
+   * compressed, see products.hpp.
+   *
+   * @param left Left factor A.
+   * @param right Right factor B.
+   * @return Matrix<T, Store> Compressed product A*B.
+   */
+  friend Matrix<T, Store> operator*(const Matrix<T, Store> &left,
+                                    const Matrix<T, Store> &right) {
+    return left._multiply_matrix(right);
+  };
+
+  /**
+   * @brief Kronecker product of two compressed matrices, assembled directly
+   * in compressed format, see kronecker.hpp.
+   *
+   * @param left Left factor A.
+   * @param right Right factor B.
+   * @return Matrix<T, Store> Compressed A (x) B.
+   */
+  friend Matrix<T, Store> kron(const Matrix<T, Store> &left,
+                               const Matrix<T, Store> &right) {
+    return left._kronecker_product(right);
+  };
+
+  /**
+   * @brief Kronecker sum of two square compressed matrices, assembled
+   * directly in compressed format, see kronecker.hpp.
+   *
+   * @param left Square matrix A of size n.
+   * @param right Square matrix B of size m.
+   * @return Matrix<T, Store> Compressed A (x) I_m + I_n (x) B.
+   */
+  friend Matrix<T, Store> kron_sum(const Matrix<T, Store> &left,
+                                   const Matrix<T, Store> &right) {
+    return left._kronecker_sum(right);
+  };
+
   /**
    * @brief Overload the output operator to print the matrix.
    *
@@ -387,17 +627,21 @@ public:
    * from the internal mapping to a three-vector representation.
    */
   void compress() {
+    _consecutive_reads = 0;
     if constexpr (Store == StorageOrder::row) {
       _compress_row();
     } else {
       _compress_col();
     };
+    if constexpr (_checked)
+      validate();
   }
   /**
    * @brief Decompress the matrix from the three-vector format back to the
    * internal mapping format.
    */
   void uncompress() {
+    _consecutive_reads = 0;
     if constexpr (Store == StorageOrder::row) {
       _uncompress_row();
     } else {
@@ -406,6 +650,129 @@ public:
   }
 
   bool is_compressed() const { return _is_compressed; };
+
+  /**
+   * @brief Number of rows, i.e. highest row index + 1. Constant time in the
+   * compressed case, otherwise the indices may have to be scanned.
+   *
+   * @return std::size_t Number of rows.
+   */
+  std::size_t rows() const {
+    if (!_is_compressed) {
+      if (_entry_value_map.empty())
+        return 0;
+      if constexpr (Store == StorageOrder::row) {
+        return _entry_value_map.rbegin()->first[0] + 1;
+      }
+      std::size_t num_rows = 0;
+      for (const auto &[k, v] : _entry_value_map)
+        num_rows = std::max(num_rows, k[0] + 1);
+      return num_rows;
+    }
+    if constexpr (Store == StorageOrder::row) {
+      return _inner.empty() ? 0 : _inner.size() - 1;
+    }
+    return _num_inner;
+  }
+
+  /**
+   * @brief Number of columns, i.e. highest column index + 1.
+   *
+   * @return std::size_t Number of columns.
+   */
+  std::size_t cols() const {
+    if (!_is_compressed) {
+      if (_entry_value_map.empty())
+        return 0;
+      if constexpr (Store == StorageOrder::col) {
+        return _entry_value_map.rbegin()->first[1] + 1;
+      }
+      std::size_t num_cols = 0;
+      for (const auto &[k, v] : _entry_value_map)
+        num_cols = std::max(num_cols, k[1] + 1);
+      return num_cols;
+    }
+    if constexpr (Store == StorageOrder::col) {
+      return _inner.empty() ? 0 : _inner.size() - 1;
+    }
+    return _num_inner;
+  }
+
+  /**
+   * @brief Number of stored (non-zero) entries.
+   *
+   * @return std::size_t Number of non-zeros.
+   */
+  std::size_t nnz() const {
+    return _is_compressed ? _values.size() : _entry_value_map.size();
+  }
+
+  // bytes of the dynamic storage, compressed vectors and caches, see memory.hpp
+  MemoryUsage memory_usage() const;
+
+  // graph partitioning of the sparsity pattern, see partition.hpp
+  std::vector<std::size_t> partition(std::size_t num_parts) const;
+  std::size_t edge_cut(const std::vector<std::size_t> &parts) const;
+  Matrix permute(const std::vector<std::size_t> &perm) const;
+  std::vector<std::size_t> nested_dissection(std::size_t leaf_size = 64) const;
+
+  // submatrix extraction, see submatrix.hpp
+  MatrixSlice<T, Store> row_slice(std::size_t first, std::size_t last) const
+    requires(Store == StorageOrder::row);
+  MatrixSlice<T, Store> col_slice(std::size_t first, std::size_t last) const
+    requires(Store == StorageOrder::col);
+  Matrix submatrix(const std::vector<std::size_t> &row_indices,
+                   const std::vector<std::size_t> &col_indices) const;
+
+  // traversal of the non-zeros, see iterators.hpp
+  SparseVectorView<const T> row(std::size_t i) const
+    requires(Store == StorageOrder::row);
+  SparseVectorView<T> row(std::size_t i)
+    requires(Store == StorageOrder::row);
+  SparseVectorView<const T> col(std::size_t j) const
+    requires(Store == StorageOrder::col);
+  SparseVectorView<T> col(std::size_t j)
+    requires(Store == StorageOrder::col);
+  std::ranges::subrange<NonZeroIterator<T, Store>> nonzeros() const;
+
+  // block-Jacobi preconditioner, see block_jacobi.hpp
+  BlockDiagonal<T> extract_block_diagonal(std::size_t block_size) const;
+
+  // coloring of the pattern for multicolor Gauss-Seidel, see gauss_seidel.hpp
+  std::vector<std::size_t> coloring() const;
+
+  // transpose and matrix-vector product into an existing vector, see products.hpp
+  Matrix transpose() const;
+  void multiply(const std::vector<T> &vec, std::vector<T> &res) const;
+
+  // structural invariants of the compressed vectors, called after every
+  // compression in debug builds, see checks.hpp
+  void validate() const;
+
+  // opt-in compression after a number of consecutive read-only operations, the
+  // non-const overloads apply it, see auto_compress.hpp
+  void set_auto_compress(std::size_t num_reads);
+  std::size_t auto_compress() const { return _auto_compress; }
+  AccessCounters access_counters() const;
+  void reset_access_counters();
+  void multiply(const std::vector<T> &vec, std::vector<T> &res);
+  template <NormOrder Norm> T norm();
+
+  // number of short, medium and long rows of the CSR product, see row_bins.hpp
+  std::array<std::size_t, 3> row_bin_sizes() const
+    requires(Store == StorageOrder::row);
+
+  // load-balanced tiled view of the CSR vectors, see csr5.hpp
+  Csr5Matrix<T> csr5() const
+    requires(Store == StorageOrder::row);
+
+  // triplets in three flat arrays, from either state, see coo.hpp
+  CooMatrix<T, Store> coo() const;
+
+private:
+  bool _owns_mapping() const {
+    return &_entry_value_map == &_own_entry_value_map;
+  }
 };
 
 // ROW ORDER METHODS
@@ -416,6 +783,87 @@ public:
 // COL ORDER METHODS
 #include "col_specilization.hpp"
 
+// GRAPH PARTITIONING
+#include "partition.hpp"
+
+// MEMORY FOOTPRINT
+#include "memory.hpp"
+
+// HASH-MAP DYNAMIC STORAGE
+#include "hash_storage.hpp"
+
+// LIST-OF-LISTS DYNAMIC STORAGE
+#include "lil_storage.hpp"
+
+// ROW-LENGTH BINNING
+#include "row_bins.hpp"
+
+// SUBMATRICES AND SLICES
+#include "submatrix.hpp"
+
+// ROW/COL VIEWS AND NON-ZERO ITERATORS
+#include "iterators.hpp"
+
+// BLOCK-JACOBI
+#include "block_jacobi.hpp"
+
+// MULTICOLOR GAUSS-SEIDEL
+#include "gauss_seidel.hpp"
+
+// SNAPSHOT FOR THE UNCOMPRESSED PRODUCT
+#include "snapshot.hpp"
+
+// DEBUG CHECKS
+#include "checks.hpp"
+
+// AUTO-COMPRESSION POLICY
+#include "auto_compress.hpp"
+
+// DETERMINISTIC REDUCTIONS
+#include "reproducible.hpp"
+
+// SPARSE PRODUCTS
+#include "products.hpp"
+
+// KRONECKER PRODUCTS
+#include "kronecker.hpp"
+
+// HYBRID DENSE/SPARSE STORAGE
+#include "dense_blocks.hpp"
+
+// JAGGED DIAGONAL STORAGE
+#include "jagged_diagonal.hpp"
+
+// CSR5 TILED VIEW
+#include "csr5.hpp"
+
+// COMPRESSED SPARSE BLOCKS
+#include "csb.hpp"
+
+// QUADTREE STORAGE
+#include "quadtree.hpp"
+
+// COORDINATE STORAGE
+#include "coo.hpp"
+
+// KRYLOV SOLVERS
+#include "solvers.hpp"
+
+// EIGENVALUE ESTIMATORS
+#include "eigen.hpp"
+
+// CHEBYSHEV SMOOTHER
+#include "chebyshev.hpp"
+
+// SPARSE DIRECT SOLVER
+#include "sparse_lu.hpp"
+
+// SUPERNODAL CHOLESKY
+#include "cholesky.hpp"
+
+// SMOOTHED AGGREGATION AMG
+#include "amg.hpp"
+
 } // namespace algebra
 
 #endif
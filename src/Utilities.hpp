@@ -18,6 +18,9 @@ enum StorageOrder { row, col };
 
 enum NormOrder { frob, one, max };
 
+// ordering of the unknowns in a Gauss-Seidel/SOR sweep
+enum SweepDirection { forward, backward, symmetric };
+
 template <typename T>
 concept Numeric = std::is_same_v<T, float> || std::is_same_v<T, double>;;
 
@@ -0,0 +1,264 @@
+#ifndef MATRIX_AMG_HPP
+#define MATRIX_AMG_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Smoothed aggregation algebraic multigrid for symmetric positive definite row-compressed
+ * matrices (Vanek, Mandel, Brezina). The setup builds the hierarchy level by level:
+ * - strength of connection: j is strongly connected to i if |a_ij| >= theta sqrt(|a_ii a_jj|),
+ * - aggregation of the strong graph (roots with free neighbourhood, then attach, then leftovers),
+ * - tentative prolongator P0 with the constant vector as near null space,
+ * - prolongator smoothing P = (I - omega D^{-1} A) P0 with omega = 4/3 / rho(D^{-1} A),
+ * - Galerkin coarse operator A_c = P^T A P.
+ * The coarsest level is solved exactly with a dense LU up to max_dense_size rows; if the
+ * coarsening stops above that size (aggregation stalled or max_levels reached), the dense LU
+ * would take O(n^2) memory and O(n^3) work, so the coarsest level is instead approximated by
+ * _coarse_sweeps symmetric Gauss-Seidel sweeps. The V-cycle uses one multicolor
+ * Gauss-Seidel sweep (forward before, backward after the correction) so that it is a symmetric
+ * preconditioner for CG, and every operation in it is parallel.
+ *
+ * @tparam T Type of the entries.
+ */
+template <Numeric T>
+class AMG {
+  using matrix_type = Matrix<T, StorageOrder::row>;
+
+  // deques, since the smoothers keep references to the operators
+  std::deque<matrix_type> _operators;
+  std::deque<matrix_type> _prolongators;
+  std::deque<matrix_type> _restrictors;
+  std::deque<MulticolorGaussSeidel<T>> _smoothers;
+  std::unique_ptr<BlockDiagonal<T>> _coarse_solver;
+  // coarsest level too large for the dense LU: forward and backward sweeps, symmetric so that
+  // the V-cycle stays a valid preconditioner for CG
+  static constexpr std::size_t _coarse_sweeps = 8;
+  std::unique_ptr<MulticolorGaussSeidel<T>> _coarse_smoother;
+  // work vectors of every level: right-hand side, solution and residual
+  mutable std::vector<std::vector<T>> _rhs, _sol, _res;
+
+  T _theta;
+
+  /**
+   * @brief Strongly connected neighbours of every row, as a graph.
+   */
+  PatternGraph _strength_graph(const matrix_type& matrix, const std::vector<T>& diag) const {
+    const std::size_t n = diag.size();
+    PatternGraph graph;
+    graph.xadj.assign(n + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto row = matrix.row(i);
+      for (std::size_t k = 0; k < row.size(); ++k) {
+        const std::size_t j = row.indices[k];
+        if (j != i && std::abs(row.values[k]) >= _theta * std::sqrt(std::abs(diag[i] * diag[j])))
+          graph.adjncy.push_back(j);
+      }
+      graph.xadj[i + 1] = graph.adjncy.size();
+    }
+    return graph;
+  }
+
+  /**
+   * @brief Greedy aggregation of the strength graph.
+   *
+   * @param graph Strength graph.
+   * @param aggregates Output, aggregate of every row.
+   * @return std::size_t Number of aggregates.
+   */
+  static std::size_t _aggregate(const PatternGraph& graph, std::vector<std::size_t>& aggregates) {
+    constexpr std::size_t free = std::numeric_limits<std::size_t>::max();
+    const std::size_t n = graph.size();
+    aggregates.assign(n, free);
+    std::size_t num_aggregates = 0;
+
+    // 1. a row whose strong neighbours are all free becomes the root of a new aggregate
+    for (std::size_t i = 0; i < n; ++i) {
+      if (aggregates[i] != free) continue;
+      bool all_free = true;
+      for (std::size_t idx = graph.xadj[i]; idx < graph.xadj[i + 1] && all_free; ++idx)
+        all_free = aggregates[graph.adjncy[idx]] == free;
+      if (!all_free) continue;
+      aggregates[i] = num_aggregates;
+      for (std::size_t idx = graph.xadj[i]; idx < graph.xadj[i + 1]; ++idx)
+        aggregates[graph.adjncy[idx]] = num_aggregates;
+      ++num_aggregates;
+    }
+    // 2. the remaining rows join an aggregate of a strong neighbour from step 1
+    const std::vector<std::size_t> first_pass = aggregates;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (aggregates[i] != free) continue;
+      for (std::size_t idx = graph.xadj[i]; idx < graph.xadj[i + 1]; ++idx) {
+        if (first_pass[graph.adjncy[idx]] != free) {
+          aggregates[i] = first_pass[graph.adjncy[idx]];
+          break;
+        }
+      }
+    }
+    // 3. leftovers build new aggregates with their free strong neighbours
+    for (std::size_t i = 0; i < n; ++i) {
+      if (aggregates[i] != free) continue;
+      aggregates[i] = num_aggregates;
+      for (std::size_t idx = graph.xadj[i]; idx < graph.xadj[i + 1]; ++idx)
+        if (aggregates[graph.adjncy[idx]] == free) aggregates[graph.adjncy[idx]] = num_aggregates;
+      ++num_aggregates;
+    }
+    return num_aggregates;
+  }
+
+  /**
+   * @brief Smoothed prolongator P = (I - omega D^{-1} A) P0.
+   */
+  static matrix_type _smoothed_prolongator(const matrix_type& matrix, const std::vector<T>& diag,
+                                           const std::vector<std::size_t>& aggregates,
+                                           std::size_t num_aggregates) {
+    const std::size_t n = diag.size();
+    // tentative prolongator, columns normalized
+    std::vector<std::size_t> agg_size(num_aggregates, 0);
+    for (auto a : aggregates) ++agg_size[a];
+    std::vector<std::size_t> p0_inner(n + 1), p0_outer(aggregates);
+    std::vector<T> p0_values(n);
+    std::iota(p0_inner.begin(), p0_inner.end(), 0);
+    for (std::size_t i = 0; i < n; ++i) p0_values[i] = 1 / std::sqrt(static_cast<T>(agg_size[aggregates[i]]));
+    const matrix_type p0(std::move(p0_inner), std::move(p0_outer), std::move(p0_values), num_aggregates);
+
+    // Gershgorin bound of the spectral radius of D^{-1} A
+    T rho = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto row = matrix.row(i);
+      T sum = 0;
+      for (std::size_t k = 0; k < row.size(); ++k) sum += std::abs(row.values[k]);
+      rho = std::max(rho, sum / std::abs(diag[i]));
+    }
+    const T omega = T(4) / 3 / rho;
+
+    // the pattern of A P0 contains the one of P0, since the diagonal of A is non-zero
+    matrix_type prolongator = matrix * p0;
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) {
+      auto row = prolongator.row(i);
+      for (std::size_t k = 0; k < row.size(); ++k) {
+        row.values[k] *= -omega / diag[i];
+        if (row.indices[k] == aggregates[i])
+          row.values[k] += 1 / std::sqrt(static_cast<T>(agg_size[aggregates[i]]));
+      }
+    }
+    return prolongator;
+  }
+
+  void _vcycle(std::size_t level) const {
+    auto& rhs = _rhs[level];
+    auto& sol = _sol[level];
+    if (level + 1 == _operators.size()) {
+      if (_coarse_solver) {
+        _coarse_solver->apply(rhs, sol);
+        return;
+      }
+      for (std::size_t s = 0; s < _coarse_sweeps; ++s) {
+        _coarse_smoother->sweep(rhs, sol, SweepDirection::forward);
+        _coarse_smoother->sweep(rhs, sol, SweepDirection::backward);
+      }
+      return;
+    }
+    auto& res = _res[level];
+    _smoothers[level].sweep(rhs, sol, SweepDirection::forward);
+
+    _operators[level].multiply(sol, res);
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < res.size(); ++i) res[i] = rhs[i] - res[i];
+    _restrictors[level].multiply(res, _rhs[level + 1]);
+    std::fill(_sol[level + 1].begin(), _sol[level + 1].end(), T(0));
+    _vcycle(level + 1);
+
+    _prolongators[level].multiply(_sol[level + 1], res);
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < sol.size(); ++i) sol[i] += res[i];
+    _smoothers[level].sweep(rhs, sol, SweepDirection::backward);
+  }
+
+public:
+  /**
+   * @brief Setup of the hierarchy.
+   *
+   * @param matrix Row-compressed SPD matrix, copied into the finest level.
+   * @param theta Strength of connection threshold, 0 keeps every non-zero as strong connection.
+   * @param max_coarse_size The coarsening stops when a level has at most this many rows.
+   * @param max_levels Maximal number of levels.
+   * @param max_dense_size Largest coarsest level solved with a dense LU, above it the coarsest
+   * level is smoothed with Gauss-Seidel sweeps.
+   */
+  explicit AMG(const matrix_type& matrix, T theta = 0, std::size_t max_coarse_size = 200,
+               std::size_t max_levels = 10, std::size_t max_dense_size = 1000)
+      : _theta(theta) {
+    if (max_coarse_size > max_dense_size) {
+      throw std::invalid_argument("The maximal coarse size exceeds the maximal dense size");
+    }
+    _operators.push_back(matrix);
+    while (_operators.size() < max_levels && _operators.back().rows() > max_coarse_size) {
+      const matrix_type& fine = _operators.back();
+      const std::size_t n = fine.rows();
+      std::vector<T> diag(n);
+      for (std::size_t i = 0; i < n; ++i) diag[i] = fine(i, i);
+
+      std::vector<std::size_t> aggregates;
+      const std::size_t num_aggregates = _aggregate(_strength_graph(fine, diag), aggregates);
+      // stop if the aggregation stalls, the coarse level would cost as much as the fine one
+      if (num_aggregates == 0 || 2 * num_aggregates > n) break;
+
+      _prolongators.push_back(_smoothed_prolongator(fine, diag, aggregates, num_aggregates));
+      _restrictors.push_back(_prolongators.back().transpose());
+      _smoothers.emplace_back(fine);
+      _operators.push_back(_restrictors.back() * (fine * _prolongators.back()));
+    }
+    const matrix_type& coarsest = _operators.back();
+    if (coarsest.rows() <= max_dense_size) {
+      _coarse_solver = std::make_unique<BlockDiagonal<T>>(
+          coarsest.extract_block_diagonal(coarsest.rows()));
+      _coarse_solver->factorize();
+    } else {
+      _coarse_smoother = std::make_unique<MulticolorGaussSeidel<T>>(coarsest);
+    }
+
+    for (const auto& op : _operators) {
+      _rhs.emplace_back(op.rows(), 0);
+      _sol.emplace_back(op.rows(), 0);
+      _res.emplace_back(op.rows(), 0);
+    }
+  }
+
+  std::size_t num_levels() const { return _operators.size(); }
+  // true if the coarsest level is solved with the dense LU, false if it is smoothed
+  bool has_direct_coarse_solve() const { return _coarse_solver != nullptr; }
+
+  /**
+   * @brief Operator complexity, i.e. total number of non-zeros of all levels over the ones of
+   * the finest level.
+   */
+  double operator_complexity() const {
+    double total = 0;
+    for (const auto& op : _operators) total += op.nnz();
+    return total / _operators.front().nnz();
+  }
+
+  /**
+   * @brief Rows of every level, from the finest to the coarsest.
+   */
+  std::vector<std::size_t> level_sizes() const {
+    std::vector<std::size_t> sizes;
+    for (const auto& op : _operators) sizes.push_back(op.rows());
+    return sizes;
+  }
+
+  /**
+   * @brief One V-cycle with zero initial guess, z = M^{-1} r, to be used as preconditioner.
+   *
+   * @param r Right-hand side.
+   * @param z Output.
+   */
+  void apply(const std::vector<T>& r, std::vector<T>& z) const {
+    _rhs[0] = r;
+    std::fill(_sol[0].begin(), _sol[0].end(), T(0));
+    _vcycle(0);
+    z = _sol[0];
+  }
+};
+#endif
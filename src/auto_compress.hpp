@@ -0,0 +1,153 @@
+#ifndef MATRIX_AUTO_COMPRESS_HPP
+#define MATRIX_AUTO_COMPRESS_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Opt-in lazy auto-compression. With set_auto_compress(n), n > 0, a matrix in the uncompressed
+ * state compresses itself before a product or a norm once n read-only operations followed each
+ * other without a write in between, and a compressed matrix uncompresses itself when a new entry
+ * is written through operator(); writes to stored entries keep the compressed state. The policy
+ * acts in the non-const overloads of operator*, multiply and norm, a const matrix never changes
+ * its state. compress() clears the mapping, also when it is owned by the user.
+ * With the policy on, the matrix counts the reads on either state, the writes and the changes of
+ * state it made, see access_counters(). The policy is off by default and then costs one branch.
+ */
+
+/**
+ * @brief How often every path of a matrix was taken since the policy was switched on.
+ */
+struct AccessCounters {
+  // products and norms on the mapping and on the compressed vectors
+  std::size_t uncompressed_reads = 0;
+  std::size_t compressed_reads = 0;
+  // accesses through the non-const operator()
+  std::size_t writes = 0;
+  // changes of state made by the policy
+  std::size_t auto_compressions = 0;
+  std::size_t auto_uncompressions = 0;
+};
+
+/**
+ * @brief Switch the auto-compression policy on (num_reads > 0) or off (0), the counters are reset.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param num_reads Number of consecutive read-only operations before compressing.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::set_auto_compress(std::size_t num_reads) {
+  _auto_compress = num_reads;
+  reset_access_counters();
+}
+
+template <Numeric T, StorageOrder Store>
+AccessCounters Matrix<T, Store>::access_counters() const {
+  return {_uncompressed_reads.load(), _compressed_reads.load(), _writes.load(),
+          _auto_compressions.load(), _auto_uncompressions.load()};
+}
+
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::reset_access_counters() {
+  _consecutive_reads = 0;
+  _uncompressed_reads = 0;
+  _compressed_reads = 0;
+  _writes = 0;
+  _auto_compressions = 0;
+  _auto_uncompressions = 0;
+}
+
+/**
+ * @brief Whether (row, col) is stored in the compressed vectors, by bisection of its row or
+ * column.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param row Row index.
+ * @param col Column index.
+ */
+template <Numeric T, StorageOrder Store>
+bool Matrix<T, Store>::_is_stored(std::size_t row, std::size_t col) const {
+  const std::size_t o = Store == StorageOrder::row ? row : col;
+  const std::size_t i = Store == StorageOrder::row ? col : row;
+  if (o + 1 >= _inner.size()) return false;
+  const auto first = _outer.begin() + _inner[o], last = _outer.begin() + _inner[o + 1];
+  // the inner indices of every outer index are sorted
+  return std::binary_search(first, last, i);
+}
+
+/**
+ * @brief Count a product or a norm, called by the const overloads.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_count_read() const {
+  if (_auto_compress == 0) return;
+  (_is_compressed ? _compressed_reads : _uncompressed_reads).fetch_add(1, std::memory_order_relaxed);
+  _consecutive_reads.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Count a write through operator() and uncompress first if (row, col) is a new entry.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param row Row index.
+ * @param col Column index.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_count_write(std::size_t row, std::size_t col) {
+  _writes.fetch_add(1, std::memory_order_relaxed);
+  _consecutive_reads.store(0, std::memory_order_relaxed);
+  if (_is_compressed && !_is_stored(row, col)) {
+    uncompress();
+    _auto_uncompressions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Compress if the policy is on and enough reads followed each other, called by the
+ * non-const overloads before the read.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_apply_auto_compress() {
+  if (_auto_compress == 0 || _is_compressed || _entry_value_map.empty()) return;
+  if (_consecutive_reads.load(std::memory_order_relaxed) >= _auto_compress) {
+    compress();
+    _auto_compressions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Matrix-vector product of a non-const matrix, applies the policy first.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param vec Vector x.
+ * @param res Output vector y, resized to the number of rows.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::multiply(const std::vector<T>& vec, std::vector<T>& res) {
+  _apply_auto_compress();
+  std::as_const(*this).multiply(vec, res);
+}
+
+/**
+ * @brief Norm of a non-const matrix, applies the policy first.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @tparam Norm options are NormOrder::frob, NormOrder::one, NormOrder::max
+ * @return T norm of the matrix
+ */
+template <Numeric T, StorageOrder Store>
+template <NormOrder Norm>
+T Matrix<T, Store>::norm() {
+  _apply_auto_compress();
+  return std::as_const(*this).template norm<Norm>();
+}
+#endif
@@ -0,0 +1,270 @@
+#ifndef MATRIX_BLOCK_JACOBI_HPP
+#define MATRIX_BLOCK_JACOBI_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Block-diagonal part of a matrix, stored as dense row-major blocks of size
+ * block_size x block_size, contiguous in memory. After factorize() it also holds the LU factors
+ * and the explicit inverse of every block, so that it can be used as a block-Jacobi
+ * preconditioner. If the size is not a multiple of the block size, the last block is padded with
+ * the identity.
+ *
+ * @tparam T Type of the entries.
+ */
+template <Numeric T>
+class BlockDiagonal {
+  std::size_t _size;
+  std::size_t _block_size;
+  std::vector<T> _blocks;
+  // filled by factorize()
+  std::vector<T> _lu;
+  std::vector<std::size_t> _pivots;
+  std::vector<T> _inverse;
+
+  std::size_t _block_entries() const { return _block_size * _block_size; }
+
+  /**
+   * @brief LU factorization with partial pivoting of block b, in place in _lu.
+   *
+   * @param b Block index.
+   * @return bool false if the block is singular.
+   */
+  bool _factorize_block(std::size_t b) {
+    const std::size_t bs = _block_size;
+    T* lu = _lu.data() + b * _block_entries();
+    std::size_t* piv = _pivots.data() + b * bs;
+    for (std::size_t k = 0; k < bs; ++k) {
+      std::size_t p = k;
+      for (std::size_t i = k + 1; i < bs; ++i)
+        if (std::abs(lu[i * bs + k]) > std::abs(lu[p * bs + k])) p = i;
+      piv[k] = p;
+      if (lu[p * bs + k] == T(0)) return false;
+      if (p != k)
+        for (std::size_t j = 0; j < bs; ++j) std::swap(lu[k * bs + j], lu[p * bs + j]);
+      for (std::size_t i = k + 1; i < bs; ++i) {
+        lu[i * bs + k] /= lu[k * bs + k];
+        for (std::size_t j = k + 1; j < bs; ++j) lu[i * bs + j] -= lu[i * bs + k] * lu[k * bs + j];
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Inverse of block b from its LU factors, column by column.
+   *
+   * @param b Block index.
+   * @param col Scratch vector of size block_size.
+   */
+  void _invert_block(std::size_t b, std::vector<T>& col) {
+    const std::size_t bs = _block_size;
+    const T* lu = _lu.data() + b * _block_entries();
+    const std::size_t* piv = _pivots.data() + b * bs;
+    T* inv = _inverse.data() + b * _block_entries();
+    for (std::size_t c = 0; c < bs; ++c) {
+      std::fill(col.begin(), col.end(), T(0));
+      col[c] = 1;
+      for (std::size_t k = 0; k < bs; ++k) std::swap(col[k], col[piv[k]]);
+      for (std::size_t i = 1; i < bs; ++i)
+        for (std::size_t j = 0; j < i; ++j) col[i] -= lu[i * bs + j] * col[j];
+      for (std::size_t i = bs; i-- > 0;) {
+        for (std::size_t j = i + 1; j < bs; ++j) col[i] -= lu[i * bs + j] * col[j];
+        col[i] /= lu[i * bs + i];
+      }
+      for (std::size_t i = 0; i < bs; ++i) inv[i * bs + c] = col[i];
+    }
+  }
+
+public:
+  /**
+   * @brief Construct a zero block diagonal (identity on the padding).
+   *
+   * @param size Size of the matrix.
+   * @param block_size Size of the blocks.
+   */
+  BlockDiagonal(std::size_t size, std::size_t block_size)
+      : _size(size), _block_size(block_size) {
+    if (block_size == 0) {
+      throw std::invalid_argument("The block size has to be positive");
+    }
+    _blocks.assign(num_blocks() * _block_entries(), 0);
+    for (std::size_t i = size; i < num_blocks() * block_size; ++i) {
+      const std::size_t b = i / block_size, l = i % block_size;
+      _blocks[b * _block_entries() + l * block_size + l] = 1;
+    }
+  }
+
+  std::size_t size() const { return _size; }
+  std::size_t block_size() const { return _block_size; }
+  std::size_t num_blocks() const { return (_size + _block_size - 1) / _block_size; }
+  bool is_factorized() const { return !_inverse.empty(); }
+
+  /**
+   * @brief Dense row-major block b.
+   */
+  std::span<T> block(std::size_t b) {
+    return std::span<T>(_blocks).subspan(b * _block_entries(), _block_entries());
+  }
+  std::span<const T> block(std::size_t b) const {
+    return std::span<const T>(_blocks).subspan(b * _block_entries(), _block_entries());
+  }
+
+  /**
+   * @brief Batched LU factorization with partial pivoting and inversion of all the blocks, in
+   * parallel over the blocks. Throws if one of the blocks is singular.
+   */
+  void factorize() {
+    _lu = _blocks;
+    _pivots.assign(num_blocks() * _block_size, 0);
+    _inverse.assign(_blocks.size(), 0);
+    bool singular = false;
+#pragma omp parallel reduction(|| : singular)
+    {
+      std::vector<T> col(_block_size);
+#pragma omp for schedule(static)
+      for (std::size_t b = 0; b < num_blocks(); ++b) {
+        if (!_factorize_block(b)) {
+          singular = true;
+          continue;
+        }
+        _invert_block(b, col);
+      }
+    }
+    if (singular) {
+      _inverse.clear();
+      throw std::runtime_error("Singular diagonal block, use a different block size");
+    }
+  }
+
+  /**
+   * @brief Block-Jacobi preconditioner z = D^{-1} r, one small dense GEMV per block with the
+   * precomputed inverses, in parallel over the blocks.
+   *
+   * @param r Right-hand side.
+   * @param z Output, resized if needed.
+   */
+  void apply(const std::vector<T>& r, std::vector<T>& z) const {
+    if (!is_factorized()) {
+      throw std::logic_error("Factorize the block diagonal first");
+    }
+    const std::size_t bs = _block_size;
+    z.resize(_size);
+#pragma omp parallel for schedule(static)
+    for (std::size_t b = 0; b < num_blocks(); ++b) {
+      const T* inv = _inverse.data() + b * _block_entries();
+      const std::size_t first = b * bs, size = std::min(bs, _size - first);
+      for (std::size_t i = 0; i < size; ++i) {
+        T sum = 0;
+        for (std::size_t j = 0; j < size; ++j) sum += inv[i * bs + j] * r[first + j];
+        z[first + i] = sum;
+      }
+    }
+  }
+
+  std::vector<T> apply(const std::vector<T>& r) const {
+    std::vector<T> z(_size);
+    apply(r, z);
+    return z;
+  }
+
+  /**
+   * @brief Product with the block diagonal, y = D x.
+   *
+   * @param diag Block diagonal D.
+   * @param vec Vector x.
+   * @return std::vector<T> y = D*x.
+   */
+  friend std::vector<T> operator*(const BlockDiagonal& diag, const std::vector<T>& vec) {
+    const std::size_t bs = diag._block_size;
+    std::vector<T> res(diag._size, 0);
+    for (std::size_t b = 0; b < diag.num_blocks(); ++b) {
+      const auto blk = diag.block(b);
+      const std::size_t first = b * bs, size = std::min(bs, diag._size - first);
+      for (std::size_t i = 0; i < size; ++i)
+        for (std::size_t j = 0; j < size; ++j) res[first + i] += blk[i * bs + j] * vec[first + j];
+    }
+    return res;
+  }
+
+  /**
+   * @brief One damped block-Jacobi sweep x <- x + omega D^{-1} (b - A x) on a row-compressed
+   * matrix, fusing the residual of each block with the block inverse so that every row of A is
+   * read once and no residual vector is stored. Parallel over the blocks.
+   *
+   * @tparam Store Storage order, only row-major is supported.
+   * @param matrix Row-compressed matrix A, whose block diagonal is this.
+   * @param rhs Right-hand side b.
+   * @param x Current iterate, updated in place.
+   * @param omega Damping parameter.
+   */
+  template <StorageOrder Store>
+  void sweep(const Matrix<T, Store>& matrix, const std::vector<T>& rhs, std::vector<T>& x,
+             T omega = 1) const
+    requires(Store == StorageOrder::row)
+  {
+    if (!is_factorized()) {
+      throw std::logic_error("Factorize the block diagonal first");
+    }
+    const std::size_t bs = _block_size;
+    const std::vector<T> x_old = x;
+#pragma omp parallel
+    {
+      std::vector<T> res_block(bs);
+#pragma omp for schedule(static)
+      for (std::size_t b = 0; b < num_blocks(); ++b) {
+        const std::size_t first = b * bs, size = std::min(bs, _size - first);
+        for (std::size_t i = 0; i < size; ++i) {
+          const auto row = matrix.row(first + i);
+          T res = rhs[first + i];
+          for (std::size_t k = 0; k < row.size(); ++k) res -= row.values[k] * x_old[row.indices[k]];
+          res_block[i] = res;
+        }
+        const T* inv = _inverse.data() + b * _block_entries();
+        for (std::size_t i = 0; i < size; ++i) {
+          T sum = 0;
+          for (std::size_t j = 0; j < size; ++j) sum += inv[i * bs + j] * res_block[j];
+          x[first + i] = x_old[first + i] + omega * sum;
+        }
+      }
+    }
+  }
+};
+
+/**
+ * @brief Extract the diagonal blocks of size block_size of a compressed matrix into dense blocks,
+ * in parallel over the blocks. Every row (col) is scanned once and only its entries inside the
+ * diagonal block are copied.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param block_size Size of the blocks.
+ * @return BlockDiagonal<T> Dense diagonal blocks, call factorize() to use them as preconditioner.
+ */
+template <Numeric T, StorageOrder Store>
+BlockDiagonal<T> Matrix<T, Store>::extract_block_diagonal(std::size_t block_size) const {
+  if (!_is_compressed) {
+    throw std::logic_error("Block diagonal extraction is only available in compressed format. Compress first");
+  }
+  const std::size_t n = std::max(rows(), cols());
+  BlockDiagonal<T> diag(n, block_size);
+  const std::size_t num_outer = _inner.size() - 1;
+#pragma omp parallel for schedule(static)
+  for (std::size_t b = 0; b < diag.num_blocks(); ++b) {
+    auto blk = diag.block(b);
+    const std::size_t first = b * block_size, last = std::min(n, first + block_size);
+    for (std::size_t o = first; o < std::min(last, num_outer); ++o) {
+      // the segment is sorted, jump to the first index inside the block
+      auto begin = _outer.begin() + _inner[o], end = _outer.begin() + _inner[o + 1];
+      for (auto it = std::lower_bound(begin, end, first); it != end && *it < last; ++it) {
+        const std::size_t idx = it - _outer.begin();
+        if constexpr (Store == StorageOrder::row) {
+          blk[(o - first) * block_size + (*it - first)] = _values[idx];
+        } else {
+          blk[(*it - first) * block_size + (o - first)] = _values[idx];
+        }
+      }
+    }
+  }
+  return diag;
+}
+#endif
@@ -0,0 +1,132 @@
+#ifndef MATRIX_CHEBYSHEV_HPP
+#define MATRIX_CHEBYSHEV_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Jacobi-scaled Chebyshev iteration of fixed degree, usable as smoother (sweep) and as
+ * symmetric polynomial preconditioner (apply). It damps the eigencomponents of D^{-1} A in
+ * [lambda_max / ratio, lambda_max]; lambda_max is estimated at setup with Lanczos on D^{-1} A and
+ * enlarged by a safety factor. Every step only needs one matrix-vector product: the residual is
+ * updated recursively, r <- r - A d, so that x is never read by the product, and in the
+ * row-compressed case the updates of x, r and of the next direction d are done in the output loop
+ * of the product, without extra passes over the vectors.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+class Chebyshev {
+  const Matrix<T, Store>& _matrix;
+  std::size_t _degree;
+  std::vector<T> _inv_diag;
+  T _lambda_min;
+  T _lambda_max;
+  // work vectors: residual, direction and next direction (or A d in the col-major case)
+  mutable std::vector<T> _r, _d, _w;
+
+  /**
+   * @brief One Chebyshev step: x += d, r -= A d, d <- c1 d + c2 D^{-1} r.
+   */
+  void _step(std::vector<T>& x, T c1, T c2) const {
+    const std::size_t n = x.size();
+    if constexpr (Store == StorageOrder::row) {
+#pragma omp parallel for schedule(static)
+      for (std::size_t i = 0; i < n; ++i) {
+        const auto row = _matrix.row(i);
+        T sum = 0;
+        for (std::size_t k = 0; k < row.size(); ++k) sum += row.values[k] * _d[row.indices[k]];
+        x[i] += _d[i];
+        _r[i] -= sum;
+        _w[i] = c1 * _d[i] + c2 * _inv_diag[i] * _r[i];
+      }
+      std::swap(_d, _w);
+    } else {
+      // the col-major product scatters into the output, so the updates need their own pass
+      _matrix.multiply(_d, _w);
+#pragma omp parallel for schedule(static)
+      for (std::size_t i = 0; i < n; ++i) {
+        x[i] += _d[i];
+        _r[i] -= _w[i];
+        _d[i] = c1 * _d[i] + c2 * _inv_diag[i] * _r[i];
+      }
+    }
+  }
+
+  /**
+   * @brief The iteration from the residual in _r, see Saad, Iterative Methods for Sparse Linear
+   * Systems, Algorithm 12.1.
+   */
+  void _iterate(std::vector<T>& x) const {
+    const T theta = (_lambda_max + _lambda_min) / 2, delta = (_lambda_max - _lambda_min) / 2;
+    const T sigma = theta / delta;
+    T rho = 1 / sigma;
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < x.size(); ++i) _d[i] = _inv_diag[i] * _r[i] / theta;
+    for (std::size_t k = 1; k < _degree; ++k) {
+      const T rho_new = 1 / (2 * sigma - rho);
+      _step(x, rho_new * rho, 2 * rho_new / delta);
+      rho = rho_new;
+    }
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < x.size(); ++i) x[i] += _d[i];
+  }
+
+public:
+  /**
+   * @brief Setup: inverse diagonal and estimate of the largest eigenvalue of D^{-1} A. The
+   * matrix must stay alive and compressed while the smoother is used.
+   *
+   * @param matrix Compressed symmetric positive definite matrix.
+   * @param degree Degree of the polynomial, i.e. number of matrix-vector products per sweep.
+   * @param ratio The damped interval is [lambda_max / ratio, lambda_max].
+   * @param lanczos_steps Maximal number of Lanczos steps of the estimate.
+   */
+  explicit Chebyshev(const Matrix<T, Store>& matrix, std::size_t degree = 3, T ratio = 30,
+                     std::size_t lanczos_steps = 20)
+      : _matrix(matrix), _degree(degree) {
+    if (degree == 0) {
+      throw std::invalid_argument("The degree of the Chebyshev polynomial has to be positive");
+    }
+    auto jacobi = matrix.extract_block_diagonal(1);
+    jacobi.factorize();
+    _inv_diag = jacobi.apply(std::vector<T>(jacobi.size(), 1));
+    // Lanczos underestimates the largest eigenvalue, amplifying it is cheaper than converging
+    _lambda_max = T(1.1) * lanczos_bounds(matrix, lanczos_steps, T(1e-2), jacobi).max;
+    _lambda_min = _lambda_max / ratio;
+    _r.resize(_inv_diag.size());
+    _d.resize(_inv_diag.size());
+    _w.resize(_inv_diag.size());
+  }
+
+  std::size_t degree() const { return _degree; }
+  T lambda_min() const { return _lambda_min; }
+  T lambda_max() const { return _lambda_max; }
+
+  /**
+   * @brief One Chebyshev sweep, degree matrix-vector products.
+   *
+   * @param rhs Right-hand side b.
+   * @param x Current iterate, updated in place.
+   */
+  void sweep(const std::vector<T>& rhs, std::vector<T>& x) const {
+    _matrix.multiply(x, _r);
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < x.size(); ++i) _r[i] = rhs[i] - _r[i];
+    _iterate(x);
+  }
+
+  /**
+   * @brief Polynomial preconditioner z = p(A) r, i.e. one sweep from a zero initial guess,
+   * degree - 1 matrix-vector products.
+   *
+   * @param r Right-hand side.
+   * @param z Output, resized if needed.
+   */
+  void apply(const std::vector<T>& r, std::vector<T>& z) const {
+    z.assign(r.size(), 0);
+    _r = r;
+    _iterate(z);
+  }
+};
+#endif
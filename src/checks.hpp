@@ -0,0 +1,77 @@
+#ifndef MATRIX_CHECKS_HPP
+#define MATRIX_CHECKS_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Debug checks. Built with -DDEBUG (the debug target of the makefile) every access through
+ * operator() in the compressed state is checked against the number of rows and columns, every
+ * product against the size of the vector, and the compressed vectors are validated after every
+ * compression and construction from vectors. Without DEBUG the checks sit behind if constexpr on
+ * _checked and are not compiled at all. A write to an entry outside the pattern of a compressed
+ * matrix throws in both builds, as before.
+ */
+
+/**
+ * @brief Throw std::out_of_range if (row, col) is outside a compressed matrix. In the uncompressed
+ * state any index is valid, the mapping defines the size.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param row Row index.
+ * @param col Column index.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_check_access(std::size_t row, std::size_t col) const {
+  if (_is_compressed && (row >= rows() || col >= cols())) {
+    throw std::out_of_range("Index (" + std::to_string(row) + ", " + std::to_string(col) +
+                            ") out of the bounds of the compressed matrix");
+  }
+}
+
+/**
+ * @brief Throw std::invalid_argument if the vector is shorter than the number of columns.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param vec Vector x of a product.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_check_vector(const std::vector<T>& vec) const {
+  if (_is_compressed && vec.size() < cols()) {
+    throw std::invalid_argument("The size of the vector does not match the matrix");
+  }
+}
+
+/**
+ * @brief Check the structure of the compressed vectors, throws std::logic_error naming the first
+ * violated invariant:
+ * - _inner starts at 0, is non-decreasing and ends at the number of non-zeros;
+ * - _outer and _values have one entry per non-zero;
+ * - the inner indices are below the number of columns (rows) and strictly increasing along every
+ *   row (column), i.e. sorted and without duplicates.
+ * Does nothing in the uncompressed state.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::validate() const {
+  if (!_is_compressed) return;
+  auto fail = [](const std::string& what) { throw std::logic_error("Invalid compressed matrix: " + what); };
+  if (_outer.size() != _values.size()) fail("indices and values differ in size");
+  if (_inner.empty()) {
+    if (!_outer.empty()) fail("non-zeros without outer pointers");
+    return;
+  }
+  if (_inner.front() != 0) fail("outer pointers do not start at 0");
+  if (_inner.back() != _outer.size()) fail("outer pointers do not end at the number of non-zeros");
+  for (std::size_t o = 0; o + 1 < _inner.size(); ++o) {
+    if (_inner[o] > _inner[o + 1]) fail("outer pointers decrease at " + std::to_string(o));
+    for (std::size_t p = _inner[o]; p < _inner[o + 1]; ++p) {
+      if (_outer[p] >= _num_inner) fail("inner index out of bounds at " + std::to_string(o));
+      if (p > _inner[o] && _outer[p - 1] >= _outer[p])
+        fail("inner indices not strictly increasing at " + std::to_string(o));
+    }
+  }
+}
+#endif
@@ -0,0 +1,361 @@
+#ifndef MATRIX_CHOLESKY_HPP
+#define MATRIX_CHOLESKY_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Supernodal sparse Cholesky factorization P A P^T = L L^T of a symmetric positive definite
+ * col-compressed matrix. The constructor is the symbolic analysis:
+ * - nested dissection ordering, followed by a postorder of the elimination tree so that the
+ *   columns of every supernode and every subtree are contiguous,
+ * - elimination tree (Liu's algorithm with path compression) and pattern of L, row by row from
+ *   the row subtrees,
+ * - relaxed supernodes: chains of columns j, parent(j) = j + 1 with nested patterns, or with few
+ *   explicit zeros, stored as dense column-major panels (diagonal block on top of the rows below),
+ * - level sets of the supernodal elimination tree: the supernodes of one level do not depend on
+ *   each other.
+ * factorize() is left-looking: every supernode gathers the updates of its descendants with a
+ * small dense product and then factors its panel with a dense column Cholesky. The supernodes
+ * of one level are factored in parallel, from the leaves to the root.
+ *
+ * @tparam T Type of the entries.
+ */
+template <Numeric T>
+class SparseCholesky {
+  using matrix_type = Matrix<T, StorageOrder::col>;
+  static constexpr std::size_t _none = std::numeric_limits<std::size_t>::max();
+
+  std::size_t _n;
+  std::vector<std::size_t> _perm;  // perm[new_index] = old_index
+  std::vector<std::size_t> _parent;
+  // supernode s holds the columns [_first[s], _first[s + 1]), its rows are
+  // _rows[_row_ptr[s]...] and its panel _values[_panel_ptr[s]...]
+  std::vector<std::size_t> _first, _row_ptr, _rows, _panel_ptr;
+  std::vector<std::size_t> _supernode_of;
+  // descendants updating every supernode, and supernodes grouped by level
+  std::vector<std::vector<std::size_t>> _updaters;
+  std::vector<std::vector<std::size_t>> _levels;
+  std::vector<T> _values;
+  bool _factorized = false;
+  mutable std::vector<T> _work;
+
+  std::size_t _num_cols(std::size_t s) const { return _first[s + 1] - _first[s]; }
+  std::size_t _num_rows(std::size_t s) const { return _row_ptr[s + 1] - _row_ptr[s]; }
+
+  /**
+   * @brief Elimination tree of a symmetric matrix from the entries above the diagonal.
+   */
+  static std::vector<std::size_t> _elimination_tree(const matrix_type& matrix) {
+    const std::size_t n = matrix.cols();
+    std::vector<std::size_t> parent(n, _none), ancestor(n, _none);
+    for (std::size_t k = 0; k < n; ++k) {
+      const auto col = matrix.col(k);
+      for (std::size_t p = 0; p < col.size(); ++p) {
+        // follow the path from i to the root of its current subtree, compressing it
+        for (std::size_t i = col.indices[p]; i != _none && i < k;) {
+          const std::size_t next = ancestor[i];
+          ancestor[i] = k;
+          if (next == _none) parent[i] = k;
+          i = next;
+        }
+      }
+    }
+    return parent;
+  }
+
+  /**
+   * @brief Postorder of a forest given by its parents.
+   */
+  static std::vector<std::size_t> _postorder(const std::vector<std::size_t>& parent) {
+    const std::size_t n = parent.size();
+    // children lists in increasing order
+    std::vector<std::size_t> head(n, _none), next(n, _none);
+    for (std::size_t j = n; j-- > 0;) {
+      if (parent[j] == _none) continue;
+      next[j] = head[parent[j]];
+      head[parent[j]] = j;
+    }
+    std::vector<std::size_t> post, stack;
+    post.reserve(n);
+    for (std::size_t root = 0; root < n; ++root) {
+      if (parent[root] != _none) continue;
+      stack.push_back(root);
+      while (!stack.empty()) {
+        const std::size_t j = stack.back();
+        if (const std::size_t child = head[j]; child != _none) {
+          head[j] = next[child];
+          stack.push_back(child);
+        } else {
+          stack.pop_back();
+          post.push_back(j);
+        }
+      }
+    }
+    return post;
+  }
+
+  /**
+   * @brief Pattern of L, column by column. Row k of L is the row subtree of k: the paths in the
+   * elimination tree from every i with a_ik != 0, i < k, up to k.
+   */
+  void _symbolic(const matrix_type& matrix, std::vector<std::vector<std::size_t>>& pattern) const {
+    pattern.assign(_n, {});
+    std::vector<std::size_t> mark(_n, _none);
+    for (std::size_t k = 0; k < _n; ++k) {
+      pattern[k].push_back(k);
+      mark[k] = k;
+      const auto col = matrix.col(k);
+      for (std::size_t p = 0; p < col.size(); ++p) {
+        for (std::size_t i = col.indices[p]; i < k && mark[i] != k; i = _parent[i]) {
+          pattern[i].push_back(k);
+          mark[i] = k;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Factor supernode s: gather A, apply the updates of the descendants, dense Cholesky of
+   * the panel.
+   *
+   * @param matrix Permuted matrix.
+   * @param s Supernode.
+   * @param relative Scratch of size n, position of every row in the panel.
+   * @param update Scratch for the dense update.
+   * @return bool false if the matrix is not positive definite.
+   */
+  bool _factor_supernode(const matrix_type& matrix, std::size_t s, std::vector<std::size_t>& relative,
+                         std::vector<T>& update) {
+    const std::size_t first = _first[s], ncols = _num_cols(s), nrows = _num_rows(s);
+    const std::size_t* rows = _rows.data() + _row_ptr[s];
+    T* panel = _values.data() + _panel_ptr[s];
+    for (std::size_t r = 0; r < nrows; ++r) relative[rows[r]] = r;
+
+    std::fill(panel, panel + ncols * nrows, T(0));
+    for (std::size_t c = 0; c < ncols; ++c) {
+      const auto col = matrix.col(first + c);
+      for (std::size_t p = 0; p < col.size(); ++p)
+        if (col.indices[p] >= first + c) panel[c * nrows + relative[col.indices[p]]] = col.values[p];
+    }
+
+    for (auto d : _updaters[s]) {
+      const std::size_t d_cols = _num_cols(d), d_rows = _num_rows(d);
+      const std::size_t* rows_d = _rows.data() + _row_ptr[d];
+      const T* panel_d = _values.data() + _panel_ptr[d];
+      // rows of d in [p1, p2) are columns of s, the rows from p1 on receive the update
+      const std::size_t p1 = std::lower_bound(rows_d + d_cols, rows_d + d_rows, first) - rows_d;
+      const std::size_t p2 = std::lower_bound(rows_d + p1, rows_d + d_rows, first + ncols) - rows_d;
+      const std::size_t m = d_rows - p1, w = p2 - p1;
+      // update = L_d[p1:, :] L_d[p1:p2, :]^T, lower part only
+      update.assign(m * w, 0);
+      for (std::size_t k = 0; k < d_cols; ++k) {
+        const T* col = panel_d + k * d_rows + p1;
+        for (std::size_t c = 0; c < w; ++c) {
+          const T a = col[c];
+          T* upd = update.data() + c * m;
+          for (std::size_t r = c; r < m; ++r) upd[r] -= col[r] * a;
+        }
+      }
+      for (std::size_t c = 0; c < w; ++c) {
+        T* target = panel + (rows_d[p1 + c] - first) * nrows;
+        for (std::size_t r = c; r < m; ++r) target[relative[rows_d[p1 + r]]] += update[c * m + r];
+      }
+    }
+
+    // dense left-looking column Cholesky of the whole panel
+    for (std::size_t j = 0; j < ncols; ++j) {
+      T* col_j = panel + j * nrows;
+      for (std::size_t k = 0; k < j; ++k) {
+        const T* col_k = panel + k * nrows;
+        const T a = col_k[j];
+        for (std::size_t r = j; r < nrows; ++r) col_j[r] -= col_k[r] * a;
+      }
+      if (col_j[j] <= T(0)) return false;
+      const T diag = std::sqrt(col_j[j]);
+      col_j[j] = diag;
+      for (std::size_t r = j + 1; r < nrows; ++r) col_j[r] /= diag;
+    }
+    return true;
+  }
+
+public:
+  /**
+   * @brief Symbolic analysis: ordering, elimination tree, pattern of L, supernodes, levels.
+   *
+   * @param matrix Symmetric col-compressed matrix, both triangles stored.
+   * @param reorder Whether to use the nested dissection ordering, or the natural one.
+   */
+  explicit SparseCholesky(const matrix_type& matrix, bool reorder = true) : _n(matrix.rows()) {
+    if (!matrix.is_compressed()) {
+      throw std::logic_error("The sparse Cholesky is only available in compressed format. Compress first");
+    }
+    if (matrix.rows() != matrix.cols()) {
+      throw std::invalid_argument("The sparse Cholesky needs a square matrix");
+    }
+    if (reorder) {
+      _perm = matrix.nested_dissection();
+    } else {
+      _perm.resize(_n);
+      std::iota(_perm.begin(), _perm.end(), 0);
+    }
+    // postorder of the elimination tree, it does not change the fill
+    const auto post = _postorder(_elimination_tree(matrix.permute(_perm)));
+    std::vector<std::size_t> perm(_n);
+    for (std::size_t k = 0; k < _n; ++k) perm[k] = _perm[post[k]];
+    _perm = std::move(perm);
+    const matrix_type permuted = matrix.permute(_perm);
+    _parent = _elimination_tree(permuted);
+
+    std::vector<std::vector<std::size_t>> pattern;
+    _symbolic(permuted, pattern);
+
+    // relaxed supernodes: j joins the supernode of j - 1 if it is its parent and the patterns are
+    // nested, or if the explicit zeros stored in the panel stay few (relaxation as in CHOLMOD)
+    _first.assign(1, 0);
+    std::size_t true_nnz = pattern[0].size();
+    for (std::size_t j = 1; j < _n; ++j) {
+      const std::size_t first = _first.back(), width = j - first + 1;
+      bool merge = _parent[j - 1] == j;
+      if (merge && pattern[j].size() + 1 != pattern[j - 1].size()) {
+        // rows of the merged panel: the columns first, ..., j and the pattern of j
+        const std::size_t num_rows = width - 1 + pattern[j].size();
+        const std::size_t stored = width * num_rows - width * (width - 1) / 2;
+        const double zeros = 1 - static_cast<double>(true_nnz + pattern[j].size()) / stored;
+        merge = width <= 4 || (width <= 16 && zeros < 0.1) || (width <= 48 && zeros < 0.05);
+      }
+      if (merge) {
+        true_nnz += pattern[j].size();
+      } else {
+        _first.push_back(j);
+        true_nnz = pattern[j].size();
+      }
+    }
+    _first.push_back(_n);
+    const std::size_t num_supernodes = _first.size() - 1;
+
+    _supernode_of.resize(_n);
+    _row_ptr.assign(1, 0);
+    _panel_ptr.assign(1, 0);
+    for (std::size_t s = 0; s < num_supernodes; ++s) {
+      const std::size_t first = _first[s], last = _first[s + 1] - 1;
+      for (std::size_t j = first; j <= last; ++j) {
+        _supernode_of[j] = s;
+        _rows.push_back(j);
+      }
+      _rows.insert(_rows.end(), pattern[last].begin() + 1, pattern[last].end());
+      _row_ptr.push_back(_rows.size());
+      _panel_ptr.push_back(_panel_ptr.back() + _num_rows(s) * _num_cols(s));
+    }
+
+    // descendants updating every supernode, in increasing order
+    _updaters.assign(num_supernodes, {});
+    for (std::size_t d = 0; d < num_supernodes; ++d) {
+      std::size_t last = _none;
+      for (std::size_t p = _row_ptr[d] + _num_cols(d); p < _row_ptr[d + 1]; ++p) {
+        const std::size_t s = _supernode_of[_rows[p]];
+        if (s != last) _updaters[s].push_back(d);
+        last = s;
+      }
+    }
+
+    // level of a supernode: one more than the highest of its children
+    std::vector<std::size_t> level(num_supernodes, 0);
+    std::size_t num_levels = 0;
+    for (std::size_t s = 0; s < num_supernodes; ++s) {
+      num_levels = std::max(num_levels, level[s] + 1);
+      if (const std::size_t p = _parent[_first[s + 1] - 1]; p != _none)
+        level[_supernode_of[p]] = std::max(level[_supernode_of[p]], level[s] + 1);
+    }
+    _levels.assign(num_levels, {});
+    for (std::size_t s = 0; s < num_supernodes; ++s) _levels[level[s]].push_back(s);
+    _work.resize(_n);
+  }
+
+  std::size_t num_supernodes() const { return _first.size() - 1; }
+  std::size_t num_levels() const { return _levels.size(); }
+
+  /**
+   * @brief Number of stored entries of L, including the explicit zeros of relaxed supernodes.
+   */
+  std::size_t nnz_factor() const {
+    std::size_t nnz = 0;
+    for (std::size_t s = 0; s < num_supernodes(); ++s) {
+      const std::size_t ncols = _num_cols(s), nrows = _num_rows(s);
+      nnz += ncols * nrows - ncols * (ncols - 1) / 2;
+    }
+    return nnz;
+  }
+
+  /**
+   * @brief Numeric factorization, level by level with the supernodes of one level in parallel.
+   * Throws if the matrix is not positive definite.
+   *
+   * @param matrix The analyzed matrix, or one with the same pattern.
+   */
+  void factorize(const matrix_type& matrix) {
+    if (matrix.rows() != _n || matrix.cols() != _n) {
+      throw std::invalid_argument("The matrix does not match the symbolic analysis");
+    }
+    const matrix_type permuted = matrix.permute(_perm);
+    _values.assign(_panel_ptr.back(), 0);
+    bool failed = false;
+    for (const auto& level : _levels) {
+#pragma omp parallel reduction(|| : failed)
+      {
+        std::vector<std::size_t> relative(_n);
+        std::vector<T> update;
+#pragma omp for schedule(dynamic)
+        for (std::size_t idx = 0; idx < level.size(); ++idx)
+          if (!_factor_supernode(permuted, level[idx], relative, update)) failed = true;
+      }
+      if (failed) {
+        _factorized = false;
+        throw std::runtime_error("The matrix is not positive definite, the Cholesky factorization failed");
+      }
+    }
+    _factorized = true;
+  }
+
+  /**
+   * @brief Solve A x = b with L y = P b and L^T P x = y, supernode by supernode.
+   *
+   * @param b Right-hand side.
+   * @param x Output, resized if needed.
+   */
+  void solve(const std::vector<T>& b, std::vector<T>& x) const {
+    if (!_factorized) {
+      throw std::logic_error("Factorize the matrix first");
+    }
+    std::vector<T>& y = _work;
+    for (std::size_t k = 0; k < _n; ++k) y[k] = b[_perm[k]];
+    for (std::size_t s = 0; s < num_supernodes(); ++s) {
+      const std::size_t nrows = _num_rows(s);
+      const std::size_t* rows = _rows.data() + _row_ptr[s];
+      const T* panel = _values.data() + _panel_ptr[s];
+      for (std::size_t c = 0; c < _num_cols(s); ++c) {
+        const T* col = panel + c * nrows;
+        const T yj = y[rows[c]] /= col[c];
+        for (std::size_t r = c + 1; r < nrows; ++r) y[rows[r]] -= col[r] * yj;
+      }
+    }
+    for (std::size_t s = num_supernodes(); s-- > 0;) {
+      const std::size_t nrows = _num_rows(s);
+      const std::size_t* rows = _rows.data() + _row_ptr[s];
+      const T* panel = _values.data() + _panel_ptr[s];
+      for (std::size_t c = _num_cols(s); c-- > 0;) {
+        const T* col = panel + c * nrows;
+        T sum = y[rows[c]];
+        for (std::size_t r = c + 1; r < nrows; ++r) sum -= col[r] * y[rows[r]];
+        y[rows[c]] = sum / col[c];
+      }
+    }
+    x.resize(_n);
+    for (std::size_t k = 0; k < _n; ++k) x[_perm[k]] = y[k];
+  }
+
+  /**
+   * @brief Same as solve, so that the factorization can be used as preconditioner.
+   */
+  void apply(const std::vector<T>& r, std::vector<T>& z) const { solve(r, z); }
+};
+#endif
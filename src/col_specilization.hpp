@@ -28,11 +28,13 @@ void Matrix<T, Store>::_compress_col() {
   _values.resize(num_non_zeros);
 
   std::size_t num_non_zero = 0;
+  _num_inner = 0;
 
   for (std::size_t col = 0; col < num_cols - 1; ++col){
     auto low = _entry_value_map.lower_bound({std::numeric_limits<std::size_t>::min(), col});
     auto up = _entry_value_map.upper_bound({std::numeric_limits<std::size_t>::max(), col}); 
     for (auto it = low; it != up; ++it) {
+      _num_inner = std::max(_num_inner, it->first[0] + 1);
       _outer[num_non_zero] = it->first[0];  // add the row index
       _values[num_non_zero] = it->second;   // add the value
      ++num_non_zero;
@@ -43,6 +45,7 @@ void Matrix<T, Store>::_compress_col() {
   // save memory and set flags
   _is_compressed = true;
   _entry_value_map.clear();
+  _drop_snapshot();
 }
 
 /**
@@ -68,9 +71,14 @@ void Matrix<T, Store>::_uncompress_col() {
   }
   // save memory and set flags
   _is_compressed = false;
+  _drop_snapshot();
   _inner.clear();
   _outer.clear();
   _values.clear();
+  _num_inner = 0;
+  _gather_inner.clear();
+  _gather_outer.clear();
+  _gather_pos.clear();
 }
 
 /**
@@ -110,7 +118,7 @@ template <Numeric T, StorageOrder Store>
 T& Matrix<T, Store>::_find_compressed_element_col(std::size_t row,
                                                   std::size_t col) {
 
-  for (std::size_t row_idx = _inner[col]; row_idx < _outer[col + 1]; ++row_idx) {
+  for (std::size_t row_idx = _inner[col]; row_idx < _inner[col + 1]; ++row_idx) {
     if (_outer[row_idx] == row) {
 
       return _values[row_idx];
@@ -132,9 +140,8 @@ T& Matrix<T, Store>::_find_compressed_element_col(std::size_t row,
 template <Numeric T, StorageOrder Store>
 std::vector<T> Matrix<T, Store>::_matrix_vector_col(std::vector<T> vec) const {
   std::vector<T> res;
-  // #rows = max value in the row-index vector
-  std::size_t num_rows = *max_element(_outer.begin(), _outer.end());
-  res.resize(num_rows + 1, 0);
+  // #rows stored at compression, empty last rows included
+  res.resize(_num_inner, 0);
   // iterate through the colums
 
   //@note two problems here. The warning should have helped you to realize that you are dealing here
@@ -163,7 +170,7 @@ std::vector<T> Matrix<T, Store>::_matrix_vector_col(std::vector<T> vec) const {
 template <Numeric T, StorageOrder Store>
 T Matrix<T, Store>::_max_norm_compressed_col() const {
 
-  std::size_t num_rows = *max_element(std::begin(_outer), std::end(_outer));
+  std::size_t num_rows = *max_element(std::begin(_outer), std::end(_outer)) + 1;
   std::vector<T> sum_abs_per_col(num_rows, 0);
   //@note another warning that can be easily fixed by using 0u.
   for (std::size_t row_idx = 0; row_idx < _outer.size(); ++row_idx) {
@@ -0,0 +1,199 @@
+#ifndef MATRIX_COO_HPP
+#define MATRIX_COO_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Coordinate (COO) storage: the triplets in three flat arrays, sorted like the mapping of
+ * the storage order, by (row, col) or by (col, row). The easiest format to stream and to split:
+ * any range of entries is a valid piece of the matrix. The product cuts the entries into chunks
+ * with the same number of non-zeros, whatever the row lengths, and reduces every chunk by
+ * segments of equal outer index; only the first and the last segment of a chunk can be shared
+ * with a neighbour, they are carried and added afterwards.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Ordering of the entries, by rows or by columns.
+ */
+template <Numeric T, StorageOrder Store>
+class CooMatrix {
+  // non-zeros of a chunk of the product, large enough for the carries to be negligible
+  static constexpr std::size_t _chunk_size = 4096;
+
+  std::size_t _rows;
+  std::size_t _cols;
+  std::vector<std::size_t> _row;
+  std::vector<std::size_t> _col;
+  std::vector<T> _values;
+
+  // index the entries are sorted by first, and the other one
+  const std::vector<std::size_t>& _outer_indices() const {
+    if constexpr (Store == StorageOrder::row) return _row; else return _col;
+  }
+  const std::vector<std::size_t>& _inner_indices() const {
+    if constexpr (Store == StorageOrder::row) return _col; else return _row;
+  }
+
+public:
+  /**
+   * @brief COO matrix from the triplets, use Matrix::coo to get them from a matrix.
+   *
+   * @param rows Number of rows.
+   * @param cols Number of columns.
+   * @param row Row indices, sorted by the storage order together with col.
+   * @param col Column indices.
+   * @param values Values.
+   */
+  CooMatrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> row,
+            std::vector<std::size_t> col, std::vector<T> values)
+      : _rows(rows), _cols(cols), _row(std::move(row)), _col(std::move(col)), _values(std::move(values)) {
+    if (_row.size() != _values.size() || _col.size() != _values.size()) {
+      throw std::invalid_argument("The row indices, column indices and values differ in size");
+    }
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t cols() const { return _cols; }
+  std::size_t nnz() const { return _values.size(); }
+  std::span<const std::size_t> row_indices() const { return _row; }
+  std::span<const std::size_t> col_indices() const { return _col; }
+  std::span<const T> values() const { return _values; }
+
+  /**
+   * @brief Bytes of the three arrays, counted as compressed storage.
+   */
+  MemoryUsage memory_usage() const {
+    MemoryUsage usage;
+    usage.compressed = _vector_bytes(_row) + _vector_bytes(_col) + _vector_bytes(_values);
+    return usage;
+  }
+
+  /**
+   * @brief y = A x. Sorted by rows, the chunks are reduced by segments of equal row in parallel.
+   * Sorted by columns the rows of a chunk are scattered, every thread accumulates into its own
+   * copy of y as in the CSC product.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _cols) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    const std::size_t nnz = _values.size(), num_rows = _rows;
+    res.assign(num_rows, 0);
+    const T* x = vec.data();
+    T* y = res.data();
+    if constexpr (Store == StorageOrder::col) {
+#pragma omp parallel for schedule(static) reduction(+ : y[:num_rows])
+      for (std::size_t k = 0; k < nnz; ++k) y[_row[k]] += _values[k] * x[_col[k]];
+      return;
+    }
+    const std::size_t num_chunks = (nnz + _chunk_size - 1) / _chunk_size;
+    // sums of the first and of the last row of every chunk
+    std::vector<std::array<T, 2>> carry(num_chunks, {0, 0});
+#pragma omp parallel for schedule(static)
+    for (std::size_t c = 0; c < num_chunks; ++c) {
+      const std::size_t first = c * _chunk_size, last = std::min(nnz, first + _chunk_size);
+      std::size_t k = first;
+      // the segments run over the entries of one row
+      auto segment_sum = [&]() {
+        const std::size_t row = _row[k];
+        T sum = 0;
+        for (; k < last && _row[k] == row; ++k) sum += _values[k] * x[_col[k]];
+        return sum;
+      };
+      carry[c][0] = segment_sum();
+      if (k == last) continue;
+      while (true) {
+        const std::size_t row = _row[k];
+        const T sum = segment_sum();
+        if (k == last) {
+          carry[c][1] = sum;
+          break;
+        }
+        y[row] = sum;
+      }
+    }
+    // the first and last rows of the chunks are shared, added in chunk order
+    for (std::size_t c = 0; c < num_chunks; ++c) {
+      const std::size_t first = c * _chunk_size, last = std::min(nnz, first + _chunk_size);
+      y[_row[first]] += carry[c][0];
+      if (_row[last - 1] != _row[first]) y[_row[last - 1]] += carry[c][1];
+    }
+  }
+
+  friend std::vector<T> operator*(const CooMatrix& matrix, const std::vector<T>& vec) {
+    std::vector<T> res;
+    matrix.multiply(vec, res);
+    return res;
+  }
+
+  /**
+   * @brief Conversion to a compressed matrix. In the storage order of the triplets only the
+   * pointers are counted and the indices and values copied, in the other order the entries are
+   * moved by a stable counting sort, which keeps the inner indices sorted. Linear in the number
+   * of non-zeros either way.
+   *
+   * @tparam S Storage order of the result, CSR for row and CSC for col.
+   * @return Matrix<T, S> Compressed matrix.
+   */
+  template <StorageOrder S = Store>
+  Matrix<T, S> to_matrix() const {
+    const std::size_t nnz = _values.size();
+    const auto& outer = S == Store ? _outer_indices() : _inner_indices();
+    const auto& inner = S == Store ? _inner_indices() : _outer_indices();
+    const std::size_t num_outer = S == StorageOrder::row ? _rows : _cols;
+    const std::size_t num_inner = S == StorageOrder::row ? _cols : _rows;
+    std::vector<std::size_t> pointers(num_outer + 1, 0);
+    for (std::size_t k = 0; k < nnz; ++k) ++pointers[outer[k] + 1];
+    std::partial_sum(pointers.begin(), pointers.end(), pointers.begin());
+    if constexpr (S == Store) {
+      return Matrix<T, S>(std::move(pointers), inner, _values, num_inner);
+    } else {
+      std::vector<std::size_t> indices(nnz);
+      std::vector<T> values(nnz);
+      std::vector<std::size_t> next(pointers.begin(), pointers.end() - 1);
+      for (std::size_t k = 0; k < nnz; ++k) {
+        const std::size_t p = next[outer[k]]++;
+        indices[p] = inner[k];
+        values[p] = _values[k];
+      }
+      return Matrix<T, S>(std::move(pointers), std::move(indices), std::move(values), num_inner);
+    }
+  }
+};
+
+/**
+ * @brief Triplets of the matrix in COO storage, sorted in the storage order. From the compressed
+ * state the outer pointers are expanded in parallel, from the uncompressed state the mapping is
+ * read in one pass, since it is already sorted.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @return CooMatrix<T, Store> Copy of the entries in three arrays.
+ */
+template <Numeric T, StorageOrder Store>
+CooMatrix<T, Store> Matrix<T, Store>::coo() const {
+  const std::size_t nnz = this->nnz();
+  std::vector<std::size_t> row(nnz), col(nnz);
+  std::vector<T> values(nnz);
+  if (!_is_compressed) {
+    std::size_t k = 0;
+    for (const auto& [key, value] : _entry_value_map) {
+      row[k] = key[0];
+      col[k] = key[1];
+      values[k++] = value;
+    }
+    return CooMatrix<T, Store>(rows(), cols(), std::move(row), std::move(col), std::move(values));
+  }
+  auto& outer = Store == StorageOrder::row ? row : col;
+  auto& inner = Store == StorageOrder::row ? col : row;
+  const std::size_t num_outer = _inner.empty() ? 0 : _inner.size() - 1;
+#pragma omp parallel for schedule(static)
+  for (std::size_t o = 0; o < num_outer; ++o)
+    std::fill(outer.begin() + _inner[o], outer.begin() + _inner[o + 1], o);
+  std::copy(_outer.begin(), _outer.end(), inner.begin());
+  std::copy(_values.begin(), _values.end(), values.begin());
+  return CooMatrix<T, Store>(rows(), cols(), std::move(row), std::move(col), std::move(values));
+}
+#endif
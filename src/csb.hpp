@@ -0,0 +1,176 @@
+#ifndef MATRIX_CSB_HPP
+#define MATRIX_CSB_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Compressed sparse blocks (CSB) storage of a compressed matrix, for products with A and
+ * with A^T at the same speed. The matrix is cut into square blocks of size _block_size (a power of
+ * two close to the square root of the dimension, at most 2^16), the blocks are stored in row-major
+ * block order behind a dense array of block pointers, and the entries of a block are stored with
+ * their 16 bits local row and column, sorted in Z-order (Morton order). Neither rows nor columns
+ * are favoured: A x runs over the block rows in parallel, each writing only its own part of y,
+ * and A^T x runs over the block columns in parallel in the same way, reading the same arrays.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order of the source matrix.
+ */
+template <Numeric T, StorageOrder Store>
+class CsbMatrix {
+  std::size_t _rows;
+  std::size_t _cols;
+  std::size_t _block_size;
+  int _shift;
+  std::size_t _block_rows;
+  std::size_t _block_cols;
+  // entries of block (I, J) are [_block_ptr[I * _block_cols + J], _block_ptr[I * _block_cols + J + 1])
+  std::vector<std::size_t> _block_ptr;
+  // local row in the high and local column in the low 16 bits
+  std::vector<std::uint32_t> _local;
+  std::vector<T> _values;
+
+  // interleave the bits of the local row (odd bits) and column (even bits)
+  static std::uint32_t _morton(std::uint32_t local) {
+    auto spread = [](std::uint32_t v) {
+      v = (v | (v << 8)) & 0x00FF00FFu;
+      v = (v | (v << 4)) & 0x0F0F0F0Fu;
+      v = (v | (v << 2)) & 0x33333333u;
+      v = (v | (v << 1)) & 0x55555555u;
+      return v;
+    };
+    return (spread(local >> 16) << 1) | spread(local & 0xFFFFu);
+  }
+
+public:
+  /**
+   * @brief Conversion of a compressed matrix: counting sort of the entries by block, then a sort
+   * of every block in Z-order, in parallel.
+   *
+   * @param matrix Compressed matrix.
+   * @param block_size Size of the square blocks, rounded up to a power of two, 0 to choose it from
+   * the dimension.
+   */
+  explicit CsbMatrix(const Matrix<T, Store>& matrix, std::size_t block_size = 0)
+      : _rows(matrix.rows()), _cols(matrix.cols()) {
+    if (!matrix.is_compressed()) {
+      throw std::logic_error("The CSB storage is only available in compressed format. Compress first");
+    }
+    if (block_size == 0) {
+      block_size = std::bit_ceil(static_cast<std::size_t>(std::sqrt(double(std::max(_rows, _cols)))));
+    }
+    _block_size = std::max<std::size_t>(std::bit_ceil(block_size), 16);
+    if (_block_size > (std::size_t(1) << 16)) {
+      throw std::invalid_argument("The CSB blocks can have at most 2^16 rows and columns");
+    }
+    _shift = std::countr_zero(_block_size);
+    _block_rows = (_rows + _block_size - 1) / _block_size;
+    _block_cols = (_cols + _block_size - 1) / _block_size;
+
+    const std::size_t mask = _block_size - 1;
+    auto block = [this](std::size_t row, std::size_t col) {
+      return (row >> _shift) * _block_cols + (col >> _shift);
+    };
+    _block_ptr.assign(_block_rows * _block_cols + 1, 0);
+    for (const auto& entry : matrix.nonzeros()) ++_block_ptr[block(entry.row, entry.col) + 1];
+    std::partial_sum(_block_ptr.begin(), _block_ptr.end(), _block_ptr.begin());
+    _local.resize(matrix.nnz());
+    _values.resize(matrix.nnz());
+    std::vector<std::size_t> next(_block_ptr.begin(), _block_ptr.end() - 1);
+    for (const auto& entry : matrix.nonzeros()) {
+      const std::size_t p = next[block(entry.row, entry.col)]++;
+      _local[p] = static_cast<std::uint32_t>(((entry.row & mask) << 16) | (entry.col & mask));
+      _values[p] = entry.value;
+    }
+
+    const std::size_t num_blocks = _block_ptr.size() - 1;
+#pragma omp parallel
+    {
+      std::vector<std::pair<std::uint32_t, std::size_t>> order;
+      std::vector<std::uint32_t> local;
+      std::vector<T> values;
+#pragma omp for schedule(dynamic, 64)
+      for (std::size_t b = 0; b < num_blocks; ++b) {
+        const std::size_t first = _block_ptr[b], last = _block_ptr[b + 1];
+        if (last - first < 2) continue;
+        order.clear();
+        for (std::size_t p = first; p < last; ++p) order.push_back({_morton(_local[p]), p});
+        std::sort(order.begin(), order.end());
+        local.resize(order.size());
+        values.resize(order.size());
+        for (std::size_t k = 0; k < order.size(); ++k) {
+          local[k] = _local[order[k].second];
+          values[k] = _values[order[k].second];
+        }
+        std::copy(local.begin(), local.end(), _local.begin() + first);
+        std::copy(values.begin(), values.end(), _values.begin() + first);
+      }
+    }
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t cols() const { return _cols; }
+  std::size_t nnz() const { return _values.size(); }
+  std::size_t block_size() const { return _block_size; }
+
+  /**
+   * @brief Bytes of the block pointers, local indices and values, counted as compressed storage.
+   */
+  MemoryUsage memory_usage() const {
+    MemoryUsage usage;
+    usage.compressed = _vector_bytes(_block_ptr) + _vector_bytes(_local) + _vector_bytes(_values);
+    return usage;
+  }
+
+  /**
+   * @brief y = A x, parallel over the block rows.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _cols) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    res.assign(_rows, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (std::size_t bi = 0; bi < _block_rows; ++bi) {
+      T* y = res.data() + (bi << _shift);
+      for (std::size_t bj = 0; bj < _block_cols; ++bj) {
+        const T* x = vec.data() + (bj << _shift);
+        const std::size_t b = bi * _block_cols + bj;
+        for (std::size_t p = _block_ptr[b]; p < _block_ptr[b + 1]; ++p)
+          y[_local[p] >> 16] += _values[p] * x[_local[p] & 0xFFFFu];
+      }
+    }
+  }
+
+  /**
+   * @brief y = A^T x, parallel over the block columns.
+   *
+   * @param vec Vector x of size rows().
+   * @param res Output vector y, resized to cols().
+   */
+  void multiply_transpose(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _rows) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    res.assign(_cols, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (std::size_t bj = 0; bj < _block_cols; ++bj) {
+      T* y = res.data() + (bj << _shift);
+      for (std::size_t bi = 0; bi < _block_rows; ++bi) {
+        const T* x = vec.data() + (bi << _shift);
+        const std::size_t b = bi * _block_cols + bj;
+        for (std::size_t p = _block_ptr[b]; p < _block_ptr[b + 1]; ++p)
+          y[_local[p] & 0xFFFFu] += _values[p] * x[_local[p] >> 16];
+      }
+    }
+  }
+
+  friend std::vector<T> operator*(const CsbMatrix& matrix, const std::vector<T>& vec) {
+    std::vector<T> res;
+    matrix.multiply(vec, res);
+    return res;
+  }
+};
+#endif
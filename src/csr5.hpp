@@ -0,0 +1,147 @@
+#ifndef MATRIX_CSR5_HPP
+#define MATRIX_CSR5_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief CSR5-like tiled view of a CSR matrix for a load-balanced product. The non-zeros are cut
+ * into tiles of _tile_size consecutive entries (4 lanes of 16 entries), independently of the row
+ * boundaries, and every tile gets a small descriptor: the row of its first entry and a bit flag of
+ * the entries which start a row. The product distributes the tiles evenly over the threads, so
+ * that every thread gets the same number of non-zeros whatever the row lengths, and reduces every
+ * tile with segmented sums between the set bits of the bit flag. The partial sum of a row started
+ * in an earlier tile is carried and added afterwards.
+ * The view works on the _inner/_outer/_values vectors of the matrix without copying or reordering
+ * them, only the descriptors are computed, so it is valid while the matrix stays compressed.
+ *
+ * @tparam T Type of the entries.
+ */
+template <Numeric T>
+class Csr5Matrix {
+  static constexpr std::size_t _tile_size = 64;
+
+  std::span<const std::size_t> _inner;
+  std::span<const std::size_t> _outer;
+  std::span<const T> _values;
+  std::size_t _cols;
+  // row of the first entry of every tile
+  std::vector<std::size_t> _tile_row;
+  // bit k of tile t is set if a row starts at entry t * _tile_size + k
+  std::vector<std::uint64_t> _bit_flag;
+  // tiles with empty rows between their first and last row
+  std::vector<std::uint8_t> _has_empty;
+
+public:
+  /**
+   * @brief Descriptors of the tiles, use Matrix::csr5 instead. Parallel over the tiles: a binary
+   * search for the first row, then a pass over the rows starting in the tile.
+   *
+   * @param inner Row pointers of the matrix.
+   * @param outer Column indices of the matrix.
+   * @param values Values of the matrix.
+   * @param cols Number of columns.
+   */
+  Csr5Matrix(std::span<const std::size_t> inner, std::span<const std::size_t> outer,
+             std::span<const T> values, std::size_t cols)
+      : _inner(inner), _outer(outer), _values(values), _cols(cols) {
+    const std::size_t nnz = _values.size(), num_rows = _inner.size() - 1;
+    const std::size_t num_tiles = (nnz + _tile_size - 1) / _tile_size;
+    _tile_row.resize(num_tiles);
+    _bit_flag.assign(num_tiles, 0);
+    _has_empty.assign(num_tiles, 0);
+#pragma omp parallel for schedule(static)
+    for (std::size_t t = 0; t < num_tiles; ++t)
+      _tile_row[t] = std::upper_bound(_inner.begin(), _inner.end(), t * _tile_size) - _inner.begin() - 1;
+#pragma omp parallel for schedule(static)
+    for (std::size_t t = 0; t < num_tiles; ++t) {
+      const std::size_t first = t * _tile_size, last = std::min(nnz, first + _tile_size);
+      for (std::size_t i = _tile_row[t]; i < num_rows && _inner[i] < last; ++i) {
+        if (_inner[i] == _inner[i + 1]) {
+          _has_empty[t] = 1;
+        } else if (_inner[i] >= first) {
+          _bit_flag[t] |= std::uint64_t(1) << (_inner[i] - first);
+        }
+      }
+    }
+  }
+
+  std::size_t rows() const { return _inner.size() - 1; }
+  std::size_t cols() const { return _cols; }
+  std::size_t nnz() const { return _values.size(); }
+  std::size_t num_tiles() const { return _tile_row.size(); }
+
+  /**
+   * @brief y = A x. The products of a tile are computed with SIMD, then summed by segments: a
+   * segment starting at a set bit is the sum of its row inside the tile and written directly, the
+   * leading segment belongs to a row started in an earlier tile and is carried.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _cols) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    const std::size_t nnz = _values.size(), num_tiles = _tile_row.size();
+    res.assign(_inner.size() - 1, 0);
+    std::vector<T> carry(num_tiles);
+    const T* x = vec.data();
+#pragma omp parallel for schedule(static)
+    for (std::size_t t = 0; t < num_tiles; ++t) {
+      const std::size_t first = t * _tile_size, length = std::min(nnz, first + _tile_size) - first;
+      const std::size_t* c = _outer.data() + first;
+      const T* v = _values.data() + first;
+      std::array<T, _tile_size> product;
+#pragma omp simd
+      for (std::size_t k = 0; k < length; ++k) product[k] = v[k] * x[c[k]];
+
+      // segments run from one set bit to the next
+      auto segment_sum = [&product](std::size_t begin, std::size_t end) {
+        T sum = 0;
+#pragma omp simd reduction(+ : sum)
+        for (std::size_t k = begin; k < end; ++k) sum += product[k];
+        return sum;
+      };
+      std::uint64_t bits = _bit_flag[t];
+      std::size_t row = _tile_row[t];
+      if ((bits & 1) == 0) carry[t] = segment_sum(0, bits ? std::countr_zero(bits) : length);
+      while (bits) {
+        const std::size_t begin = std::countr_zero(bits);
+        bits &= bits - 1;
+        if (begin > 0) {
+          ++row;
+          if (_has_empty[t])
+            while (_inner[row] == _inner[row + 1]) ++row;
+        }
+        res[row] = segment_sum(begin, bits ? std::countr_zero(bits) : length);
+      }
+    }
+    // the carries of a row spanning several tiles are added in tile order
+    for (std::size_t t = 0; t < num_tiles; ++t)
+      if ((_bit_flag[t] & 1) == 0) res[_tile_row[t]] += carry[t];
+  }
+
+  friend std::vector<T> operator*(const Csr5Matrix& matrix, const std::vector<T>& vec) {
+    std::vector<T> res;
+    matrix.multiply(vec, res);
+    return res;
+  }
+};
+
+/**
+ * @brief CSR5-like tiled view of a row-compressed matrix.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @return Csr5Matrix<T> View on the compressed vectors with the tile descriptors.
+ */
+template <Numeric T, StorageOrder Store>
+Csr5Matrix<T> Matrix<T, Store>::csr5() const
+  requires(Store == StorageOrder::row)
+{
+  if (!_is_compressed) {
+    throw std::logic_error("The CSR5 view is only available in compressed format. Compress first");
+  }
+  return Csr5Matrix<T>(_inner, _outer, _values, cols());
+}
+#endif
@@ -0,0 +1,178 @@
+#ifndef MATRIX_DENSE_BLOCKS_HPP
+#define MATRIX_DENSE_BLOCKS_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Hybrid dense/sparse storage of a compressed matrix. At construction the matrix is cut
+ * into square tiles of size tile_size; the tiles whose fill reaches the density threshold are
+ * stored as dense row-major rectangles (consecutive dense tiles of a tile row are merged into one
+ * rectangle), everything else stays in CSR. The product runs over the tile rows in parallel: the
+ * CSR part first, then the dense rectangles as GEMVs whose rows are contiguous dot products, which
+ * vectorize without index loads.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order of the source matrix, the hybrid storage is always row-oriented.
+ */
+template <Numeric T, StorageOrder Store>
+class DenseBlockMatrix {
+  /**
+   * @brief Dense rectangle A(row : row + num_rows, col : col + num_cols), its values start at
+   * offset in _dense.
+   */
+  struct Block {
+    std::size_t row;
+    std::size_t col;
+    std::size_t num_rows;
+    std::size_t num_cols;
+    std::size_t offset;
+  };
+
+  std::size_t _rows;
+  std::size_t _cols;
+  std::size_t _tile_size;
+  // sparse remainder in CSR
+  std::vector<std::size_t> _inner;
+  std::vector<std::size_t> _outer;
+  std::vector<T> _values;
+  // dense rectangles, those of tile row t are _blocks[_block_ptr[t], _block_ptr[t + 1])
+  std::vector<Block> _blocks;
+  std::vector<std::size_t> _block_ptr;
+  std::vector<T> _dense;
+
+  /**
+   * @brief Detection of the dense tiles and split of the entries, one tile row at a time.
+   *
+   * @param row Access to row i as a SparseVectorView.
+   * @param density Minimal fraction of non-zeros of a dense tile.
+   */
+  template <typename RowAccess>
+  void _split(RowAccess&& row, double density) {
+    constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+    const std::size_t ts = _tile_size;
+    const std::size_t num_tile_rows = (_rows + ts - 1) / ts, num_tile_cols = (_cols + ts - 1) / ts;
+    std::vector<std::size_t> count(num_tile_cols, 0), block_of(num_tile_cols, none), touched;
+    _inner.assign(1, 0);
+    _block_ptr.assign(1, 0);
+    for (std::size_t t = 0; t < num_tile_rows; ++t) {
+      const std::size_t first = t * ts, last = std::min(_rows, first + ts);
+      for (std::size_t i = first; i < last; ++i)
+        for (auto j : row(i).indices)
+          if (count[j / ts]++ == 0) touched.push_back(j / ts);
+      std::sort(touched.begin(), touched.end());
+
+      // runs of consecutive dense tiles become one rectangle
+      for (std::size_t k = 0; k < touched.size(); ++k) {
+        const std::size_t tc = touched[k];
+        const std::size_t width = std::min(_cols, (tc + 1) * ts) - tc * ts;
+        if (count[tc] < density * static_cast<double>((last - first) * width)) continue;
+        if (k > 0 && touched[k - 1] + 1 == tc && block_of[tc - 1] != none) {
+          _blocks.back().num_cols += width;
+        } else {
+          _blocks.push_back({first, tc * ts, last - first, width, 0});
+        }
+        block_of[tc] = _blocks.size() - 1;
+      }
+      for (std::size_t b = _block_ptr.back(); b < _blocks.size(); ++b) {
+        _blocks[b].offset = _dense.size();
+        _dense.resize(_dense.size() + _blocks[b].num_rows * _blocks[b].num_cols, 0);
+      }
+
+      for (std::size_t i = first; i < last; ++i) {
+        const auto r = row(i);
+        for (std::size_t p = 0; p < r.size(); ++p) {
+          const std::size_t j = r.indices[p], b = block_of[j / ts];
+          if (b != none) {
+            const Block& block = _blocks[b];
+            _dense[block.offset + (i - first) * block.num_cols + (j - block.col)] = r.values[p];
+          } else {
+            _outer.push_back(j);
+            _values.push_back(r.values[p]);
+          }
+        }
+        _inner.push_back(_outer.size());
+      }
+      _block_ptr.push_back(_blocks.size());
+      for (auto tc : touched) {
+        count[tc] = 0;
+        block_of[tc] = none;
+      }
+      touched.clear();
+    }
+  }
+
+public:
+  /**
+   * @brief Split of a compressed matrix into dense rectangles and a CSR remainder.
+   *
+   * @param matrix Compressed matrix.
+   * @param tile_size Size of the square tiles the detection works on.
+   * @param density Minimal fraction of non-zeros for a tile to be stored dense.
+   */
+  explicit DenseBlockMatrix(const Matrix<T, Store>& matrix, std::size_t tile_size = 16,
+                            double density = 0.5)
+      : _rows(matrix.rows()), _cols(matrix.cols()), _tile_size(tile_size) {
+    if (!matrix.is_compressed()) {
+      throw std::logic_error("Dense block detection is only available in compressed format. Compress first");
+    }
+    if (tile_size == 0 || density <= 0 || density > 1) {
+      throw std::invalid_argument("The tile size has to be positive and the density in (0, 1]");
+    }
+    _outer.reserve(matrix.nnz());
+    _values.reserve(matrix.nnz());
+    if constexpr (Store == StorageOrder::row) {
+      _split([&matrix](std::size_t i) { return matrix.row(i); }, density);
+    } else {
+      const auto transposed = matrix.transpose();
+      _split([&transposed](std::size_t i) { return transposed.col(i); }, density);
+    }
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t cols() const { return _cols; }
+  std::size_t num_blocks() const { return _blocks.size(); }
+  // stored entries of the dense rectangles, explicit zeros included
+  std::size_t dense_entries() const { return _dense.size(); }
+  std::size_t sparse_nnz() const { return _values.size(); }
+
+  /**
+   * @brief y = A x.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _cols) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    res.resize(_rows);
+    const std::size_t num_tile_rows = _block_ptr.size() - 1;
+#pragma omp parallel for schedule(dynamic, 4)
+    for (std::size_t t = 0; t < num_tile_rows; ++t) {
+      const std::size_t first = t * _tile_size, last = std::min(_rows, first + _tile_size);
+      for (std::size_t i = first; i < last; ++i) {
+        T sum = 0;
+        for (std::size_t p = _inner[i]; p < _inner[i + 1]; ++p) sum += _values[p] * vec[_outer[p]];
+        res[i] = sum;
+      }
+      for (std::size_t b = _block_ptr[t]; b < _block_ptr[t + 1]; ++b) {
+        const Block& block = _blocks[b];
+        const T* x = vec.data() + block.col;
+        for (std::size_t r = 0; r < block.num_rows; ++r) {
+          const T* a = _dense.data() + block.offset + r * block.num_cols;
+          T sum = 0;
+#pragma omp simd reduction(+ : sum)
+          for (std::size_t c = 0; c < block.num_cols; ++c) sum += a[c] * x[c];
+          res[block.row + r] += sum;
+        }
+      }
+    }
+  }
+
+  friend std::vector<T> operator*(const DenseBlockMatrix& matrix, const std::vector<T>& vec) {
+    std::vector<T> res;
+    matrix.multiply(vec, res);
+    return res;
+  }
+};
+#endif
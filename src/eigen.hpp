@@ -0,0 +1,181 @@
+#ifndef MATRIX_EIGEN_HPP
+#define MATRIX_EIGEN_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Iterative estimators of extreme eigenvalues. They only need matrix-vector products with
+ * Matrix::multiply, which writes into preallocated vectors, and optionally a preconditioner M with
+ * apply(r, z), in which case they estimate the eigenvalues of M^{-1} A (e.g. D^{-1} A for Jacobi
+ * smoothing). The start vector is drawn with a fixed seed, so the estimates are reproducible.
+ */
+
+/**
+ * @brief Estimate of one eigenvalue.
+ */
+template <Numeric T>
+struct EigenEstimate {
+  T value;
+  std::size_t iterations;
+  bool converged;
+};
+
+/**
+ * @brief Estimates of the smallest and the largest eigenvalue.
+ */
+template <Numeric T>
+struct SpectralBounds {
+  T min;
+  T max;
+  std::size_t iterations;
+  bool converged;
+};
+
+/**
+ * @brief Reproducible random start vector with entries in [-1, 1].
+ */
+template <Numeric T>
+std::vector<T> _start_vector(std::size_t size) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<T> dis(-1, 1);
+  std::vector<T> vec(size);
+  for (auto& v : vec) v = dis(gen);
+  return vec;
+}
+
+/**
+ * @brief Number of eigenvalues smaller than x of the symmetric tridiagonal matrix with diagonal
+ * alpha and off-diagonal beta (Sturm sequence).
+ */
+template <Numeric T>
+std::size_t _sturm_count(const std::vector<T>& alpha, const std::vector<T>& beta, T x) {
+  std::size_t count = 0;
+  T d = 1;
+  for (std::size_t i = 0; i < alpha.size(); ++i) {
+    d = alpha[i] - x - (i > 0 ? beta[i - 1] * beta[i - 1] / d : T(0));
+    if (d == T(0)) d = std::numeric_limits<T>::epsilon() * (std::abs(alpha[i]) + std::abs(x) + 1);
+    if (d < 0) ++count;
+  }
+  return count;
+}
+
+/**
+ * @brief Smallest and largest eigenvalue of a symmetric tridiagonal matrix, by bisection on the
+ * Sturm count inside the Gershgorin interval.
+ *
+ * @param alpha Diagonal.
+ * @param beta Off-diagonal, one entry less than alpha.
+ * @return std::pair<T, T> Smallest and largest eigenvalue.
+ */
+template <Numeric T>
+std::pair<T, T> _tridiagonal_extreme_eigenvalues(const std::vector<T>& alpha, const std::vector<T>& beta) {
+  const std::size_t m = alpha.size();
+  T lower = std::numeric_limits<T>::max(), upper = std::numeric_limits<T>::lowest();
+  for (std::size_t i = 0; i < m; ++i) {
+    const T radius = (i > 0 ? std::abs(beta[i - 1]) : T(0)) + (i + 1 < m ? std::abs(beta[i]) : T(0));
+    lower = std::min(lower, alpha[i] - radius);
+    upper = std::max(upper, alpha[i] + radius);
+  }
+  // smallest x such that at least k eigenvalues are <= x
+  auto bisect = [&](std::size_t k) {
+    T lo = lower, hi = upper;
+    const T eps = std::numeric_limits<T>::epsilon() * std::max(std::abs(lower), std::abs(upper));
+    for (std::size_t it = 0; it < 200 && hi - lo > 2 * eps; ++it) {
+      const T mid = (lo + hi) / 2;
+      if (_sturm_count(alpha, beta, mid) >= k) hi = mid;
+      else lo = mid;
+    }
+    return (lo + hi) / 2;
+  };
+  return {bisect(1), bisect(m)};
+}
+
+/**
+ * @brief Power iteration for the spectral radius of A (or M^{-1} A): x <- A x / ||A x||. The
+ * estimate is the geometric mean of the last two norm ratios, i.e. sqrt(||A^2 x|| / ||x||), so
+ * that it also converges when the two dominant eigenvalues are +-lambda and the ratios alternate.
+ * Stops when two estimates differ by less than tol relative to the estimate.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @tparam Preconditioner Type of the preconditioner.
+ * @param matrix Compressed square matrix A.
+ * @param max_iter Maximal number of iterations.
+ * @param tol Relative tolerance for the early termination.
+ * @param precond Preconditioner M, identity by default.
+ * @return EigenEstimate<T> Estimate of the largest absolute value of the eigenvalues.
+ */
+template <Numeric T, StorageOrder Store, typename Preconditioner = IdentityPreconditioner<T>>
+EigenEstimate<T> power_iteration(const Matrix<T, Store>& matrix, std::size_t max_iter = 100,
+                                 T tol = 1e-3, const Preconditioner& precond = Preconditioner()) {
+  std::vector<T> x = _start_vector<T>(matrix.rows()), y(x.size()), z(x.size());
+  T norm = std::sqrt(_dot(x, x)), prev_norm = 0, estimate = 0;
+  for (std::size_t it = 1; it <= max_iter; ++it) {
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < x.size(); ++i) x[i] /= norm;
+    matrix.multiply(x, y);
+    precond.apply(y, z);
+    std::swap(x, z);
+    norm = std::sqrt(_dot(x, x));
+    if (norm == T(0)) return {0, it, true};
+    const T new_estimate = it == 1 ? norm : std::sqrt(norm * prev_norm);
+    prev_norm = norm;
+    const bool converged = it > 2 && std::abs(new_estimate - estimate) < tol * new_estimate;
+    estimate = new_estimate;
+    if (converged) return {estimate, it, true};
+  }
+  return {estimate, max_iter, false};
+}
+
+/**
+ * @brief k-step Lanczos estimate of the smallest and largest eigenvalue of a symmetric matrix A,
+ * or of M^{-1} A for a symmetric positive definite preconditioner M (Lanczos in the M-inner
+ * product). The extreme eigenvalues of the tridiagonal Lanczos matrix converge much faster than
+ * the power iteration; no reorthogonalization is done since spurious copies of converged Ritz
+ * values do not move the extreme ones. Stops when both extreme Ritz values change by less than
+ * tol relative to the largest one, or when an invariant subspace is found.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @tparam Preconditioner Type of the preconditioner.
+ * @param matrix Compressed symmetric matrix A.
+ * @param max_steps Maximal number of Lanczos steps k.
+ * @param tol Relative tolerance for the early termination.
+ * @param precond Preconditioner M, identity by default.
+ * @return SpectralBounds<T> Extreme Ritz values, which lie inside the spectrum.
+ */
+template <Numeric T, StorageOrder Store, typename Preconditioner = IdentityPreconditioner<T>>
+SpectralBounds<T> lanczos_bounds(const Matrix<T, Store>& matrix, std::size_t max_steps = 30,
+                                 T tol = 1e-3, const Preconditioner& precond = Preconditioner()) {
+  const std::size_t n = matrix.rows();
+  std::vector<T> r = _start_vector<T>(n), z(n), v(n), v_prev(n, 0), u(n), w(n);
+  std::vector<T> alpha, beta;
+  precond.apply(r, z);
+  T b = std::sqrt(_dot(r, z));
+  SpectralBounds<T> bounds{0, 0, 0, false};
+  for (std::size_t k = 1; k <= max_steps; ++k) {
+    // v_k = r / beta_k and u_k = M^{-1} v_k
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) {
+      v_prev[i] = v[i];
+      v[i] = r[i] / b;
+      u[i] = z[i] / b;
+    }
+    matrix.multiply(u, w);
+    const T a = _dot(u, w);
+    alpha.push_back(a);
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) r[i] = w[i] - a * v[i] - b * v_prev[i];
+    precond.apply(r, z);
+    b = std::sqrt(std::max(_dot(r, z), T(0)));
+
+    const auto [lambda_min, lambda_max] = _tridiagonal_extreme_eigenvalues(alpha, beta);
+    const T scale = std::max(std::abs(lambda_min), std::abs(lambda_max));
+    const bool converged = k > 1 && std::abs(lambda_min - bounds.min) < tol * scale &&
+                           std::abs(lambda_max - bounds.max) < tol * scale;
+    bounds = {lambda_min, lambda_max, k, converged || b <= std::numeric_limits<T>::epsilon() * scale};
+    if (bounds.converged) break;
+    beta.push_back(b);
+  }
+  return bounds;
+}
+#endif
@@ -0,0 +1,134 @@
+#ifndef MATRIX_GAUSS_SEIDEL_HPP
+#define MATRIX_GAUSS_SEIDEL_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Greedy distance-1 coloring of the pattern graph of A + A^T: two indices coupled by a
+ * non-zero never get the same color, so all the unknowns of one color can be relaxed in parallel
+ * by Gauss-Seidel. The indices are visited in natural order, which gives the red-black coloring
+ * on structured grids.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @return std::vector<std::size_t> Color of every index, colors are 0, 1, ..., #colors - 1.
+ */
+template <Numeric T, StorageOrder Store>
+std::vector<std::size_t> Matrix<T, Store>::coloring() const {
+  const PatternGraph graph = _pattern_graph();
+  const std::size_t n = graph.size();
+  constexpr std::size_t uncolored = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> colors(n, uncolored);
+  // forbidden[c] == v if color c is used by a neighbour of v
+  std::vector<std::size_t> forbidden;
+  for (std::size_t v = 0; v < n; ++v) {
+    for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1]; ++idx) {
+      if (const std::size_t c = colors[graph.adjncy[idx]]; c != uncolored) forbidden[c] = v;
+    }
+    std::size_t c = 0;
+    while (c < forbidden.size() && forbidden[c] == v) ++c;
+    if (c == forbidden.size()) forbidden.push_back(uncolored);
+    colors[v] = c;
+  }
+  return colors;
+}
+
+/**
+ * @brief Relax one row of x: x_i <- (1 - omega) x_i + omega / a_ii (b_i - sum_{j != i} a_ij x_j).
+ */
+template <Numeric T>
+inline void _relax_row(const SparseVectorView<const T>& row, std::size_t i, T diag,
+                       const std::vector<T>& rhs, std::vector<T>& x, T omega) {
+  // the diagonal term is subtracted in the loop, so start by adding it back
+  T sum = rhs[i] + diag * x[i];
+  for (std::size_t k = 0; k < row.size(); ++k) sum -= row.values[k] * x[row.indices[k]];
+  x[i] = (1 - omega) * x[i] + omega * sum / diag;
+}
+
+/**
+ * @brief Multicolor Gauss-Seidel/SOR smoother for a row-compressed matrix. The setup colors the
+ * pattern and groups the rows by color, every sweep then relaxes the colors one after the other
+ * and the rows of one color in parallel. This is Gauss-Seidel in the color ordering, so the
+ * iterates differ from the ones of the natural ordering but converge in the same way.
+ *
+ * @tparam T Type of the entries.
+ */
+template <Numeric T>
+class MulticolorGaussSeidel {
+  const Matrix<T, StorageOrder::row>& _matrix;
+  std::vector<T> _diag;
+  std::vector<std::size_t> _color_offsets;  // rows of color c are _color_rows[offsets[c]...]
+  std::vector<std::size_t> _color_rows;
+
+  void _relax_color(std::size_t c, const std::vector<T>& rhs, std::vector<T>& x, T omega) const {
+#pragma omp parallel for schedule(static)
+    for (std::size_t k = _color_offsets[c]; k < _color_offsets[c + 1]; ++k) {
+      const std::size_t i = _color_rows[k];
+      _relax_row(_matrix.row(i), i, _diag[i], rhs, x, omega);
+    }
+  }
+
+public:
+  /**
+   * @brief Setup: coloring, rows grouped by color and diagonal. The matrix must stay
+   * alive and compressed while the smoother is used.
+   *
+   * @param matrix Row-compressed square matrix with non-zero diagonal.
+   */
+  explicit MulticolorGaussSeidel(const Matrix<T, StorageOrder::row>& matrix)
+      : _matrix(matrix), _diag(matrix.rows()) {
+    if (matrix.rows() != matrix.cols()) {
+      throw std::invalid_argument("Gauss-Seidel needs a square matrix");
+    }
+    for (std::size_t i = 0; i < _diag.size(); ++i) {
+      _diag[i] = matrix(i, i);
+      if (_diag[i] == T(0)) {
+        throw std::invalid_argument("Gauss-Seidel needs a non-zero diagonal");
+      }
+    }
+    const auto colors = matrix.coloring();
+    const std::size_t num_colors = colors.empty() ? 0 : *max_element(colors.begin(), colors.end()) + 1;
+    _color_rows = partition_permutation(colors, num_colors);
+    _color_offsets.assign(num_colors + 1, 0);
+    for (auto c : colors) ++_color_offsets[c + 1];
+    std::partial_sum(_color_offsets.begin(), _color_offsets.end(), _color_offsets.begin());
+  }
+
+  std::size_t num_colors() const { return _color_offsets.size() - 1; }
+
+  /**
+   * @brief One multicolor Gauss-Seidel/SOR sweep. Forward visits the colors 0, ..., #colors-1,
+   * backward in reverse order, symmetric does both.
+   *
+   * @param rhs Right-hand side b.
+   * @param x Current iterate, updated in place.
+   * @param direction Forward, backward or symmetric sweep.
+   * @param omega Relaxation parameter, 1 for Gauss-Seidel.
+   */
+  void sweep(const std::vector<T>& rhs, std::vector<T>& x,
+             SweepDirection direction = SweepDirection::forward, T omega = 1) const {
+    if (direction != SweepDirection::backward)
+      for (std::size_t c = 0; c < num_colors(); ++c) _relax_color(c, rhs, x, omega);
+    if (direction != SweepDirection::forward)
+      for (std::size_t c = num_colors(); c-- > 0;) _relax_color(c, rhs, x, omega);
+  }
+
+  /**
+   * @brief Serial Gauss-Seidel/SOR sweep in the natural ordering, the reference for the
+   * multicolor sweep. Forward visits the rows 0, ..., n-1, backward n-1, ..., 0.
+   *
+   * @param rhs Right-hand side b.
+   * @param x Current iterate, updated in place.
+   * @param direction Forward, backward or symmetric sweep.
+   * @param omega Relaxation parameter, 1 for Gauss-Seidel.
+   */
+  void sweep_natural(const std::vector<T>& rhs, std::vector<T>& x,
+                     SweepDirection direction = SweepDirection::forward, T omega = 1) const {
+    const std::size_t n = _diag.size();
+    if (direction != SweepDirection::backward)
+      for (std::size_t i = 0; i < n; ++i) _relax_row(_matrix.row(i), i, _diag[i], rhs, x, omega);
+    if (direction != SweepDirection::forward)
+      for (std::size_t i = n; i-- > 0;) _relax_row(_matrix.row(i), i, _diag[i], rhs, x, omega);
+  }
+};
+#endif
@@ -0,0 +1,175 @@
+#ifndef MATRIX_HASH_STORAGE_HPP
+#define MATRIX_HASH_STORAGE_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Dynamic storage for assembly in random order, used in place of Matrix::matrix_type when
+ * the entries do not arrive sorted. The entries live in an open-addressing hash table with linear
+ * probing, keyed by (outer, inner) packed into 64 bits, in the storage order of Store: an insertion
+ * is a hash and a few probes in two flat arrays, without tree rebalancing or a node allocation.
+ * The order is only established by compress(), which sorts every row (column) separately and
+ * returns the compressed Matrix.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order of the compressed matrix.
+ */
+template <Numeric T, StorageOrder Store = StorageOrder::row>
+class HashMatrix {
+  static constexpr std::uint64_t _empty = std::numeric_limits<std::uint64_t>::max();
+  static constexpr std::size_t _max_index = std::numeric_limits<std::uint32_t>::max();
+
+  // capacity is a power of two, at most half of the slots are used
+  std::vector<std::uint64_t> _keys;
+  std::vector<T> _values;
+  std::size_t _size = 0;
+  int _shift = 64;
+  std::size_t _rows = 0;
+  std::size_t _cols = 0;
+
+  static std::uint64_t _pack(std::size_t row, std::size_t col) {
+    if (row >= _max_index || col >= _max_index) {
+      throw std::out_of_range("HashMatrix indices have to be smaller than 2^32 - 1");
+    }
+    if constexpr (Store == StorageOrder::row) {
+      return (std::uint64_t(row) << 32) | col;
+    } else {
+      return (std::uint64_t(col) << 32) | row;
+    }
+  }
+
+  // Fibonacci hashing, the high bits of the product are well mixed
+  std::size_t _slot(std::uint64_t key) const {
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> _shift);
+  }
+
+  /**
+   * @brief Slot of the key, or the empty slot where it would be inserted.
+   */
+  std::size_t _probe(std::uint64_t key) const {
+    const std::size_t mask = _keys.size() - 1;
+    std::size_t s = _slot(key);
+    while (_keys[s] != key && _keys[s] != _empty) s = (s + 1) & mask;
+    return s;
+  }
+
+  void _rehash(std::size_t capacity) {
+    std::vector<std::uint64_t> keys(capacity, _empty);
+    std::vector<T> values(capacity);
+    std::swap(keys, _keys);
+    std::swap(values, _values);
+    _shift = 64 - std::countr_zero(capacity);
+    for (std::size_t s = 0; s < keys.size(); ++s) {
+      if (keys[s] == _empty) continue;
+      const std::size_t t = _probe(keys[s]);
+      _keys[t] = keys[s];
+      _values[t] = values[s];
+    }
+  }
+
+public:
+  /**
+   * @brief Empty storage with room for expected_nnz entries before the first rehash.
+   *
+   * @param expected_nnz Expected number of entries.
+   */
+  explicit HashMatrix(std::size_t expected_nnz = 0) { reserve(expected_nnz); }
+
+  /**
+   * @brief Make room for nnz entries without rehashing.
+   *
+   * @param nnz Number of entries.
+   */
+  void reserve(std::size_t nnz) {
+    const std::size_t capacity = std::bit_ceil(std::max<std::size_t>(2 * nnz, 16));
+    if (capacity > _keys.size()) _rehash(capacity);
+  }
+
+  /**
+   * @brief Setter, inserts a zero entry if (row, col) is not stored yet, so that
+   * matrix(i, j) += value accumulates like with the mapping.
+   *
+   * @param row Row index.
+   * @param col Column index.
+   * @return T& Entry of the matrix.
+   */
+  T& operator()(std::size_t row, std::size_t col) {
+    const std::uint64_t key = _pack(row, col);
+    std::size_t s = _probe(key);
+    if (_keys[s] == _empty) {
+      if (2 * (_size + 1) > _keys.size()) {
+        _rehash(2 * _keys.size());
+        s = _probe(key);
+      }
+      _keys[s] = key;
+      _values[s] = 0;
+      ++_size;
+      _rows = std::max(_rows, row + 1);
+      _cols = std::max(_cols, col + 1);
+    }
+    return _values[s];
+  }
+
+  /**
+   * @brief Getter, 0 for entries which are not stored.
+   *
+   * @param row Row index.
+   * @param col Column index.
+   * @return T Value of the entry.
+   */
+  T operator()(std::size_t row, std::size_t col) const {
+    if (row >= _rows || col >= _cols) return 0;
+    const std::size_t s = _probe(_pack(row, col));
+    return _keys[s] == _empty ? T(0) : _values[s];
+  }
+
+  std::size_t nnz() const { return _size; }
+  std::size_t rows() const { return _rows; }
+  std::size_t cols() const { return _cols; }
+
+  /**
+   * @brief Bytes of the hash table, counted as dynamic storage.
+   */
+  MemoryUsage memory_usage() const {
+    MemoryUsage usage;
+    usage.dynamic = _vector_bytes(_keys) + _vector_bytes(_values);
+    return usage;
+  }
+
+  /**
+   * @brief Build the compressed matrix: counting sort of the entries by outer index, then a sort
+   * of every row (column) by inner index, in parallel. The hash table is left unchanged.
+   *
+   * @return Matrix<T, Store> Compressed matrix with the stored entries.
+   */
+  Matrix<T, Store> compress() const {
+    if (_size == 0) {
+      throw std::logic_error("Cannot compress an empty matrix");
+    }
+    const std::size_t num_outer = Store == StorageOrder::row ? _rows : _cols;
+    std::vector<std::size_t> inner(num_outer + 1, 0);
+    for (auto key : _keys)
+      if (key != _empty) ++inner[(key >> 32) + 1];
+    std::partial_sum(inner.begin(), inner.end(), inner.begin());
+
+    std::vector<std::pair<std::size_t, T>> entries(_size);
+    std::vector<std::size_t> pos(inner.begin(), inner.end() - 1);
+    for (std::size_t s = 0; s < _keys.size(); ++s)
+      if (_keys[s] != _empty) entries[pos[_keys[s] >> 32]++] = {_keys[s] & 0xFFFFFFFFull, _values[s]};
+
+    std::vector<std::size_t> outer(_size);
+    std::vector<T> values(_size);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (std::size_t o = 0; o < num_outer; ++o) {
+      std::sort(entries.begin() + inner[o], entries.begin() + inner[o + 1],
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+      for (std::size_t p = inner[o]; p < inner[o + 1]; ++p) {
+        outer[p] = entries[p].first;
+        values[p] = entries[p].second;
+      }
+    }
+    return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values),
+                            Store == StorageOrder::row ? _cols : _rows);
+  }
+};
+#endif
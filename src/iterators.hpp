@@ -0,0 +1,209 @@
+#ifndef MATRIX_ITERATORS_HPP
+#define MATRIX_ITERATORS_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief View of one row of a CSR matrix (or one column of a CSC matrix): the column (row)
+ * indices and the values of its non-zeros, as spans into the compressed vectors. The view is
+ * invalidated by uncompress() or by the destruction of the matrix.
+ * Views exist only along the storage order (rows of CSR, columns of CSC) and only in the
+ * compressed state, where the entries are contiguous; row()/col() throw std::logic_error on an
+ * uncompressed matrix. NonZeroIterator covers the uncompressed state.
+ *
+ * @tparam V Type of the values, const T for read-only access.
+ */
+template <typename V>
+struct SparseVectorView {
+  std::span<const std::size_t> indices;
+  std::span<V> values;
+
+  std::size_t size() const { return indices.size(); }
+  bool empty() const { return indices.empty(); }
+};
+
+/**
+ * @brief Non-zero entry returned by the non-zero iterator.
+ */
+template <Numeric T>
+struct NonZero {
+  std::size_t row;
+  std::size_t col;
+  T value;
+};
+
+/**
+ * @brief Forward iterator over the non-zeros of a matrix, in the storage order, for both the
+ * compressed and the uncompressed state. It models std::forward_iterator, so
+ * Matrix::nonzeros() can be used with the standard range algorithms.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+class NonZeroIterator {
+public:
+  using map_iterator = typename std::map<
+      std::array<std::size_t, 2>, T,
+      std::conditional_t<Store == StorageOrder::row, RowOrderComparator<T>,
+                         ColOrderComparator<T>>>::const_iterator;
+  using value_type = NonZero<T>;
+  using difference_type = std::ptrdiff_t;
+  using iterator_concept = std::forward_iterator_tag;
+
+private:
+  // compressed state: position in the vectors and current row (col)
+  std::span<const std::size_t> _inner;
+  const std::size_t* _outer = nullptr;
+  const T* _values = nullptr;
+  std::size_t _pos = 0;
+  std::size_t _outer_pos = 0;
+  // uncompressed state
+  map_iterator _it{};
+  bool _is_compressed = false;
+
+  // move _outer_pos forward to the row (col) containing _pos, skipping empty ones
+  void _skip_empty() {
+    while (_outer_pos + 1 < _inner.size() && _inner[_outer_pos + 1] <= _pos) ++_outer_pos;
+  }
+
+public:
+  NonZeroIterator() = default;
+
+  /**
+   * @brief Iterator over the compressed vectors, positioned at the pos-th non-zero.
+   */
+  NonZeroIterator(std::span<const std::size_t> inner, const std::size_t* outer, const T* values,
+                  std::size_t pos)
+      : _inner(inner), _outer(outer), _values(values), _pos(pos), _is_compressed(true) {
+    _skip_empty();
+  }
+
+  /**
+   * @brief Iterator over the mapping of the uncompressed state.
+   */
+  explicit NonZeroIterator(map_iterator it) : _it(it), _is_compressed(false) {}
+
+  value_type operator*() const {
+    if (!_is_compressed) return {_it->first[0], _it->first[1], _it->second};
+    if constexpr (Store == StorageOrder::row) {
+      return {_outer_pos, _outer[_pos], _values[_pos]};
+    } else {
+      return {_outer[_pos], _outer_pos, _values[_pos]};
+    }
+  }
+
+  NonZeroIterator& operator++() {
+    if (!_is_compressed) {
+      ++_it;
+      return *this;
+    }
+    ++_pos;
+    _skip_empty();
+    return *this;
+  }
+
+  NonZeroIterator operator++(int) {
+    NonZeroIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  friend bool operator==(const NonZeroIterator& a, const NonZeroIterator& b) {
+    return a._is_compressed ? a._pos == b._pos : a._it == b._it;
+  }
+};
+
+/**
+ * @brief Read-only view of row i of a row-compressed matrix.
+ *
+ * @param i Row index.
+ * @return SparseVectorView<const T> Column indices and values of the row.
+ */
+template <Numeric T, StorageOrder Store>
+SparseVectorView<const T> Matrix<T, Store>::row(std::size_t i) const
+  requires(Store == StorageOrder::row)
+{
+  return _compressed_vector_view(i);
+}
+
+/**
+ * @brief Row i of a row-compressed matrix, whose values can be modified.
+ *
+ * @param i Row index.
+ * @return SparseVectorView<T> Column indices and values of the row.
+ */
+template <Numeric T, StorageOrder Store>
+SparseVectorView<T> Matrix<T, Store>::row(std::size_t i)
+  requires(Store == StorageOrder::row)
+{
+  const auto view = _compressed_vector_view(i);
+  if (view.empty()) return {view.indices, {}};
+  return {view.indices, std::span<T>(_values).subspan(_inner[i], view.size())};
+}
+
+/**
+ * @brief Read-only view of column j of a column-compressed matrix.
+ *
+ * @param j Column index.
+ * @return SparseVectorView<const T> Row indices and values of the column.
+ */
+template <Numeric T, StorageOrder Store>
+SparseVectorView<const T> Matrix<T, Store>::col(std::size_t j) const
+  requires(Store == StorageOrder::col)
+{
+  return _compressed_vector_view(j);
+}
+
+/**
+ * @brief Column j of a column-compressed matrix, whose values can be modified.
+ *
+ * @param j Column index.
+ * @return SparseVectorView<T> Row indices and values of the column.
+ */
+template <Numeric T, StorageOrder Store>
+SparseVectorView<T> Matrix<T, Store>::col(std::size_t j)
+  requires(Store == StorageOrder::col)
+{
+  const auto view = _compressed_vector_view(j);
+  if (view.empty()) return {view.indices, {}};
+  return {view.indices, std::span<T>(_values).subspan(_inner[j], view.size())};
+}
+
+/**
+ * @brief Helper for row()/col(): spans over the o-th segment of the compressed vectors.
+ *
+ * @param o Row index for CSR, column index for CSC.
+ * @return SparseVectorView<const T> Indices and values of the segment.
+ */
+template <Numeric T, StorageOrder Store>
+SparseVectorView<const T> Matrix<T, Store>::_compressed_vector_view(std::size_t o) const {
+  if (!_is_compressed) {
+    throw std::logic_error("Row/column views are only available in compressed format. Compress first");
+  }
+  if (o + 1 >= _inner.size()) {
+    // empty trailing rows (cols) are not stored
+    return {};
+  }
+  const std::size_t length = _inner[o + 1] - _inner[o];
+  return {std::span<const std::size_t>(_outer).subspan(_inner[o], length),
+          std::span<const T>(_values).subspan(_inner[o], length)};
+}
+
+/**
+ * @brief Range over all the non-zeros of the matrix, in the storage order, e.g.
+ * for (auto [i, j, v] : matrix.nonzeros()) ...
+ * Works in both states and with the std::ranges algorithms.
+ *
+ * @return std::ranges::subrange<NonZeroIterator<T, Store>> Range of NonZero entries.
+ */
+template <Numeric T, StorageOrder Store>
+std::ranges::subrange<NonZeroIterator<T, Store>> Matrix<T, Store>::nonzeros() const {
+  using iterator = NonZeroIterator<T, Store>;
+  if (!_is_compressed) {
+    return {iterator(_entry_value_map.cbegin()), iterator(_entry_value_map.cend())};
+  }
+  return {iterator(_inner, _outer.data(), _values.data(), 0),
+          iterator(_inner, _outer.data(), _values.data(), _values.size())};
+}
+#endif
@@ -0,0 +1,132 @@
+#ifndef MATRIX_JAGGED_DIAGONAL_HPP
+#define MATRIX_JAGGED_DIAGONAL_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Jagged diagonal storage (JDS) of a compressed matrix. The rows are permuted by decreasing
+ * number of non-zeros, and the d-th entries of all rows which have more than d entries form the
+ * d-th jagged diagonal, stored contiguously in permuted row order. Since the rows are sorted, the
+ * d-th diagonal covers the first _jd_ptr[d + 1] - _jd_ptr[d] permuted rows, so the product is a
+ * sequence of long unit-stride vector updates, one per diagonal, whose length does not depend on
+ * the length of the individual rows.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order of the source matrix, JDS is always row-oriented.
+ */
+template <Numeric T, StorageOrder Store>
+class JdsMatrix {
+  // rows of the permuted matrix handled together in the product, small enough for the partial
+  // sums to stay in the L1 cache
+  static constexpr std::size_t _row_block = 512;
+
+  std::size_t _rows;
+  std::size_t _cols;
+  // _perm[k] is the original index of the k-th longest row
+  std::vector<std::size_t> _perm;
+  // diagonal d is _outer/_values[_jd_ptr[d], _jd_ptr[d + 1]), one entry per permuted row
+  std::vector<std::size_t> _jd_ptr;
+  std::vector<std::size_t> _outer;
+  std::vector<T> _values;
+
+  /**
+   * @brief Counting sort of the rows by decreasing length (stable), then the transposition of
+   * the entries into diagonals.
+   *
+   * @param row Access to row i as a SparseVectorView.
+   */
+  template <typename RowAccess>
+  void _build(RowAccess&& row) {
+    std::size_t max_length = 0;
+    for (std::size_t i = 0; i < _rows; ++i) max_length = std::max(max_length, row(i).size());
+    // rows bucketed by max_length - length, so that the longest come first
+    std::vector<std::size_t> start(max_length + 2, 0);
+    for (std::size_t i = 0; i < _rows; ++i) ++start[max_length - row(i).size() + 1];
+    std::partial_sum(start.begin(), start.end(), start.begin());
+    _perm.resize(_rows);
+    for (std::size_t i = 0; i < _rows; ++i) _perm[start[max_length - row(i).size()]++] = i;
+
+    // diagonal d covers the k permuted rows with more than d entries
+    _jd_ptr.assign(max_length + 1, 0);
+    for (std::size_t d = 0, k = _rows; d < max_length; ++d) {
+      while (k > 0 && row(_perm[k - 1]).size() <= d) --k;
+      _jd_ptr[d + 1] = _jd_ptr[d] + k;
+    }
+    _outer.resize(_jd_ptr.back());
+    _values.resize(_jd_ptr.back());
+#pragma omp parallel for schedule(static)
+    for (std::size_t k = 0; k < _rows; ++k) {
+      const auto r = row(_perm[k]);
+      for (std::size_t d = 0; d < r.size(); ++d) {
+        _outer[_jd_ptr[d] + k] = r.indices[d];
+        _values[_jd_ptr[d] + k] = r.values[d];
+      }
+    }
+  }
+
+public:
+  /**
+   * @brief Conversion of a compressed matrix into jagged diagonals.
+   *
+   * @param matrix Compressed matrix.
+   */
+  explicit JdsMatrix(const Matrix<T, Store>& matrix) : _rows(matrix.rows()), _cols(matrix.cols()) {
+    if (!matrix.is_compressed()) {
+      throw std::logic_error("The jagged diagonal storage is only available in compressed format. Compress first");
+    }
+    if constexpr (Store == StorageOrder::row) {
+      _build([&matrix](std::size_t i) { return matrix.row(i); });
+    } else {
+      const auto transposed = matrix.transpose();
+      _build([&transposed](std::size_t i) { return transposed.col(i); });
+    }
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t cols() const { return _cols; }
+  std::size_t nnz() const { return _values.size(); }
+  // number of jagged diagonals, i.e. the length of the longest row
+  std::size_t num_diagonals() const { return _jd_ptr.size() - 1; }
+  // original row index of every permuted row, longest row first
+  const std::vector<std::size_t>& permutation() const { return _perm; }
+
+  /**
+   * @brief y = A x in the original row order. Blocks of _row_block permuted rows are distributed
+   * over the threads, every block accumulates all the diagonals which reach it with SIMD updates
+   * and scatters its sums through the permutation.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _cols) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    res.resize(_rows);
+    const std::size_t num_blocks = (_rows + _row_block - 1) / _row_block;
+    const std::size_t num_diagonals = _jd_ptr.size() - 1;
+    const T* x = vec.data();
+#pragma omp parallel for schedule(dynamic, 1)
+    for (std::size_t b = 0; b < num_blocks; ++b) {
+      const std::size_t first = b * _row_block, last = std::min(_rows, first + _row_block);
+      std::array<T, _row_block> sum{};
+      for (std::size_t d = 0; d < num_diagonals; ++d) {
+        const std::size_t length = _jd_ptr[d + 1] - _jd_ptr[d];
+        if (length <= first) break;
+        const std::size_t* c = _outer.data() + _jd_ptr[d];
+        const T* v = _values.data() + _jd_ptr[d];
+        const std::size_t end = std::min(last, length);
+#pragma omp simd
+        for (std::size_t k = first; k < end; ++k) sum[k - first] += v[k] * x[c[k]];
+      }
+      for (std::size_t k = first; k < last; ++k) res[_perm[k]] = sum[k - first];
+    }
+  }
+
+  friend std::vector<T> operator*(const JdsMatrix& matrix, const std::vector<T>& vec) {
+    std::vector<T> res;
+    matrix.multiply(vec, res);
+    return res;
+  }
+};
+#endif
@@ -0,0 +1,229 @@
+#ifndef MATRIX_KRONECKER_HPP
+#define MATRIX_KRONECKER_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Kronecker products and sums built directly in compressed format. The non-zeros of every outer
+ * index of the result are known in advance from the ones of the factors, so the compressed
+ * vectors are allocated once with their final size and filled in parallel, already sorted,
+ * without going through the map. The formulas only use outer/inner indices and hold for CSR and
+ * CSC alike.
+ */
+
+/**
+ * @brief Helper for kron(A, B).
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param right Right factor B.
+ * @return Matrix<T, Store> Compressed A (x) B.
+ */
+template <Numeric T, StorageOrder Store>
+Matrix<T, Store> Matrix<T, Store>::_kronecker_product(const Matrix<T, Store>& right) const {
+  if (!_is_compressed || !right._is_compressed) {
+    throw std::logic_error("The Kronecker product is only available in compressed format. Compress first");
+  }
+  const std::size_t outer_a = _inner.size() - 1, outer_b = right._inner.size() - 1;
+  const std::size_t inner_b = right._num_inner;
+
+  // outer index (o_a, o_b) has nnz(o_a) * nnz(o_b) entries
+  std::vector<std::size_t> inner(outer_a * outer_b + 1, 0);
+  for (std::size_t o_a = 0; o_a < outer_a; ++o_a)
+    for (std::size_t o_b = 0; o_b < outer_b; ++o_b)
+      inner[o_a * outer_b + o_b + 1] = (_inner[o_a + 1] - _inner[o_a]) * (right._inner[o_b + 1] - right._inner[o_b]);
+  std::partial_sum(inner.begin(), inner.end(), inner.begin());
+
+  std::vector<std::size_t> outer(inner.back());
+  std::vector<T> values(inner.back());
+#pragma omp parallel for schedule(dynamic, 16)
+  for (std::size_t o_a = 0; o_a < outer_a; ++o_a) {
+    for (std::size_t o_b = 0; o_b < outer_b; ++o_b) {
+      std::size_t pos = inner[o_a * outer_b + o_b];
+      for (std::size_t pa = _inner[o_a]; pa < _inner[o_a + 1]; ++pa) {
+        const std::size_t shift = _outer[pa] * inner_b;
+        for (std::size_t pb = right._inner[o_b]; pb < right._inner[o_b + 1]; ++pb) {
+          outer[pos] = shift + right._outer[pb];
+          values[pos++] = _values[pa] * right._values[pb];
+        }
+      }
+    }
+  }
+  // cols(A) cols(B) in CSR, rows(A) rows(B) in CSC
+  return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values), _num_inner * inner_b);
+}
+
+/**
+ * @brief Helper for kron_sum(A, B).
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param right Square matrix B.
+ * @return Matrix<T, Store> Compressed A (x) I + I (x) B.
+ */
+template <Numeric T, StorageOrder Store>
+Matrix<T, Store> Matrix<T, Store>::_kronecker_sum(const Matrix<T, Store>& right) const {
+  if (!_is_compressed || !right._is_compressed) {
+    throw std::logic_error("The Kronecker sum is only available in compressed format. Compress first");
+  }
+  if (rows() != cols() || right.rows() != right.cols()) {
+    throw std::invalid_argument("The Kronecker sum needs square matrices");
+  }
+  constexpr std::size_t no_entry = std::numeric_limits<std::size_t>::max();
+  const std::size_t n = _inner.size() - 1, m = right._inner.size() - 1;
+  // position of the diagonal entry of every outer index, if any
+  auto diagonal = [](const Matrix& matrix, std::size_t o) {
+    auto begin = matrix._outer.begin() + matrix._inner[o], end = matrix._outer.begin() + matrix._inner[o + 1];
+    auto it = std::lower_bound(begin, end, o);
+    return (it != end && *it == o) ? static_cast<std::size_t>(it - matrix._outer.begin()) : no_entry;
+  };
+  std::vector<std::size_t> diag_a(n), diag_b(m);
+  for (std::size_t i = 0; i < n; ++i) diag_a[i] = diagonal(*this, i);
+  for (std::size_t k = 0; k < m; ++k) diag_b[k] = diagonal(right, k);
+
+  // outer index (i, k) has the entries of A at (j, k) and of B at (i, l), which meet at (i, k)
+  std::vector<std::size_t> inner(n * m + 1, 0);
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t k = 0; k < m; ++k)
+      inner[i * m + k + 1] = (_inner[i + 1] - _inner[i]) + (right._inner[k + 1] - right._inner[k]) -
+                             (diag_a[i] != no_entry && diag_b[k] != no_entry);
+  std::partial_sum(inner.begin(), inner.end(), inner.begin());
+
+  std::vector<std::size_t> outer(inner.back());
+  std::vector<T> values(inner.back());
+#pragma omp parallel for schedule(dynamic, 16)
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t k = 0; k < m; ++k) {
+      std::size_t pos = inner[i * m + k];
+      auto emit = [&](std::size_t idx, T value) {
+        outer[pos] = idx;
+        values[pos++] = value;
+      };
+      std::size_t pa = _inner[i];
+      for (; pa < _inner[i + 1] && _outer[pa] < i; ++pa) emit(_outer[pa] * m + k, _values[pa]);
+      // block i: the entries of B, with the diagonal entry of A added at l = k
+      bool placed = diag_a[i] == no_entry;
+      const T a_diag = placed ? T(0) : _values[pa++];
+      for (std::size_t pb = right._inner[k]; pb < right._inner[k + 1]; ++pb) {
+        const std::size_t l = right._outer[pb];
+        if (!placed && l > k) {
+          emit(i * m + k, a_diag);
+          placed = true;
+        }
+        if (!placed && l == k) {
+          emit(i * m + l, right._values[pb] + a_diag);
+          placed = true;
+        } else {
+          emit(i * m + l, right._values[pb]);
+        }
+      }
+      if (!placed) emit(i * m + k, a_diag);
+      for (; pa < _inner[i + 1]; ++pa) emit(_outer[pa] * m + k, _values[pa]);
+    }
+  }
+  return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values), n * m);
+}
+
+/**
+ * @brief Kronecker product A (x) B applied without assembling it: with x reshaped into the
+ * matrix X of size cols(A) x cols(B), (A (x) B) x = vec(A X B^T). The product costs
+ * cols(A) nnz(B) + nnz(A) rows(B) instead of nnz(A) nnz(B), and only needs one intermediate of
+ * size cols(A) x rows(B). Both stages are parallel.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+class KroneckerOperator {
+  const Matrix<T, Store>& _a;
+  const Matrix<T, Store>& _b;
+  // Z = X B^T, row j is B times row j of X
+  mutable std::vector<T> _z;
+
+public:
+  /**
+   * @brief The factors must stay alive and compressed while the operator is used.
+   *
+   * @param a Left factor A.
+   * @param b Right factor B.
+   */
+  KroneckerOperator(const Matrix<T, Store>& a, const Matrix<T, Store>& b) : _a(a), _b(b) {
+    if (!a.is_compressed() || !b.is_compressed()) {
+      throw std::logic_error("The Kronecker operator needs compressed factors. Compress first");
+    }
+    _z.resize(a.cols() * b.rows());
+  }
+
+  std::size_t rows() const { return _a.rows() * _b.rows(); }
+  std::size_t cols() const { return _a.cols() * _b.cols(); }
+
+  /**
+   * @brief y = (A (x) B) x.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    const std::size_t a_rows = _a.rows(), a_cols = _a.cols();
+    const std::size_t b_rows = _b.rows(), b_cols = _b.cols();
+    if (vec.size() != cols()) {
+      throw std::invalid_argument("The size of the vector does not match the Kronecker operator");
+    }
+#pragma omp parallel for schedule(static)
+    for (std::size_t j = 0; j < a_cols; ++j) {
+      const T* x = vec.data() + j * b_cols;
+      T* z = _z.data() + j * b_rows;
+      if constexpr (Store == StorageOrder::row) {
+        for (std::size_t k = 0; k < b_rows; ++k) {
+          const auto row = _b.row(k);
+          T sum = 0;
+          for (std::size_t p = 0; p < row.size(); ++p) sum += row.values[p] * x[row.indices[p]];
+          z[k] = sum;
+        }
+      } else {
+        std::fill(z, z + b_rows, T(0));
+        for (std::size_t l = 0; l < b_cols; ++l) {
+          const auto col = _b.col(l);
+          for (std::size_t p = 0; p < col.size(); ++p) z[col.indices[p]] += col.values[p] * x[l];
+        }
+      }
+    }
+
+    // Y = A Z, the rows of Z are contiguous so the inner loops are dense AXPYs
+    res.assign(a_rows * b_rows, 0);
+    if constexpr (Store == StorageOrder::row) {
+#pragma omp parallel for schedule(dynamic, 16)
+      for (std::size_t i = 0; i < a_rows; ++i) {
+        const auto row = _a.row(i);
+        T* y = res.data() + i * b_rows;
+        for (std::size_t p = 0; p < row.size(); ++p) {
+          const T a = row.values[p];
+          const T* z = _z.data() + row.indices[p] * b_rows;
+          for (std::size_t k = 0; k < b_rows; ++k) y[k] += a * z[k];
+        }
+      }
+    } else {
+      // parallel over blocks of the columns of Y, so that no two threads write the same entry
+      constexpr std::size_t block = 64;
+#pragma omp parallel for schedule(static)
+      for (std::size_t first = 0; first < b_rows; first += block) {
+        const std::size_t last = std::min(first + block, b_rows);
+        for (std::size_t j = 0; j < a_cols; ++j) {
+          const auto col = _a.col(j);
+          const T* z = _z.data() + j * b_rows;
+          for (std::size_t p = 0; p < col.size(); ++p) {
+            const T a = col.values[p];
+            T* y = res.data() + col.indices[p] * b_rows;
+            for (std::size_t k = first; k < last; ++k) y[k] += a * z[k];
+          }
+        }
+      }
+    }
+  }
+
+  friend std::vector<T> operator*(const KroneckerOperator& op, const std::vector<T>& vec) {
+    std::vector<T> res;
+    op.multiply(vec, res);
+    return res;
+  }
+};
+#endif
@@ -0,0 +1,285 @@
+#ifndef MATRIX_LIL_STORAGE_HPP
+#define MATRIX_LIL_STORAGE_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Inclusive prefix sum in place, parallel over a fixed number of blocks: sums of the
+ * blocks, scan of the block sums, scan inside every block with its offset.
+ */
+inline void _parallel_prefix_sum(std::vector<std::size_t>& vec) {
+  constexpr std::size_t num_blocks = 64;
+  const std::size_t block = (vec.size() + num_blocks - 1) / num_blocks;
+  std::array<std::size_t, num_blocks + 1> offsets{};
+#pragma omp parallel for schedule(static)
+  for (std::size_t b = 0; b < num_blocks; ++b) {
+    const std::size_t first = std::min(vec.size(), b * block), last = std::min(vec.size(), first + block);
+    offsets[b + 1] = std::accumulate(vec.begin() + first, vec.begin() + last, std::size_t(0));
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+#pragma omp parallel for schedule(static)
+  for (std::size_t b = 0; b < num_blocks; ++b) {
+    const std::size_t first = std::min(vec.size(), b * block), last = std::min(vec.size(), first + block);
+    std::size_t sum = offsets[b];
+    for (std::size_t i = first; i < last; ++i) vec[i] = sum += vec[i];
+  }
+}
+
+/**
+ * @brief Entries of one row (column) of a LilMatrix, sorted by index. The first N entries are
+ * stored inline, longer rows move to the heap with doubling capacity.
+ *
+ * @tparam T Type of the entries.
+ * @tparam N Inline capacity.
+ */
+template <Numeric T, std::size_t N>
+class SmallRow {
+  std::size_t _size = 0;
+  std::size_t _capacity = N;
+  std::array<std::size_t, N> _inline_indices;
+  std::array<T, N> _inline_values;
+  std::unique_ptr<std::size_t[]> _heap_indices;
+  std::unique_ptr<T[]> _heap_values;
+
+  void _grow() {
+    const std::size_t capacity = 2 * _capacity;
+    auto indices = std::make_unique<std::size_t[]>(capacity);
+    auto values = std::make_unique<T[]>(capacity);
+    std::copy(this->indices(), this->indices() + _size, indices.get());
+    std::copy(this->values(), this->values() + _size, values.get());
+    _heap_indices = std::move(indices);
+    _heap_values = std::move(values);
+    _capacity = capacity;
+  }
+
+public:
+  SmallRow() = default;
+  SmallRow(SmallRow&& other) noexcept
+      : _size(other._size), _capacity(other._capacity), _inline_indices(other._inline_indices),
+        _inline_values(other._inline_values), _heap_indices(std::move(other._heap_indices)),
+        _heap_values(std::move(other._heap_values)) {
+    other._size = 0;
+    other._capacity = N;
+  }
+  SmallRow(const SmallRow& other) : _size(other._size), _capacity(other._capacity) {
+    if (other._heap_indices) {
+      _heap_indices = std::make_unique<std::size_t[]>(_capacity);
+      _heap_values = std::make_unique<T[]>(_capacity);
+    }
+    std::copy(other.indices(), other.indices() + _size, indices());
+    std::copy(other.values(), other.values() + _size, values());
+  }
+
+  std::size_t size() const { return _size; }
+  std::size_t* indices() { return _heap_indices ? _heap_indices.get() : _inline_indices.data(); }
+  const std::size_t* indices() const { return _heap_indices ? _heap_indices.get() : _inline_indices.data(); }
+  T* values() { return _heap_values ? _heap_values.get() : _inline_values.data(); }
+  const T* values() const { return _heap_values ? _heap_values.get() : _inline_values.data(); }
+
+  /**
+   * @brief Position of index in the row, or size() if it is not stored.
+   */
+  std::size_t find(std::size_t index) const {
+    const std::size_t* first = indices();
+    const std::size_t* it = std::lower_bound(first, first + _size, index);
+    return (it != first + _size && *it == index) ? static_cast<std::size_t>(it - first) : _size;
+  }
+
+  /**
+   * @brief Value of index, inserted as zero at its sorted position if not stored yet.
+   */
+  T& at(std::size_t index) {
+    std::size_t* first = indices();
+    const std::size_t pos = std::lower_bound(first, first + _size, index) - first;
+    if (pos < _size && first[pos] == index) return values()[pos];
+    if (_size == _capacity) _grow();
+    std::size_t* idx = indices();
+    T* val = values();
+    std::copy_backward(idx + pos, idx + _size, idx + _size + 1);
+    std::copy_backward(val + pos, val + _size, val + _size + 1);
+    idx[pos] = index;
+    val[pos] = 0;
+    ++_size;
+    return val[pos];
+  }
+
+  // heap bytes, the inline part is counted with the row itself
+  std::size_t heap_bytes() const {
+    return _heap_indices ? _capacity * (sizeof(std::size_t) + sizeof(T)) : 0;
+  }
+};
+
+/**
+ * @brief List-of-lists dynamic storage: one SmallRow per row (column for Store = col), sorted by
+ * column (row) index. It replaces Matrix::matrix_type when the rows are assembled independently:
+ * inserts only touch their own row, so different rows can be filled by different threads, and
+ * since every row is already sorted, compress() is a parallel prefix sum of the row sizes and a
+ * copy of every row into the compressed vectors. The number of rows and columns is fixed at
+ * construction.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order, also of the compressed matrix.
+ * @tparam N Number of entries stored inline in every row.
+ */
+template <Numeric T, StorageOrder Store = StorageOrder::row, std::size_t N = 8>
+class LilMatrix {
+  std::size_t _rows;
+  std::size_t _cols;
+  std::vector<SmallRow<T, N>> _lists;
+
+  void _check(std::size_t row, std::size_t col) const {
+    if (row >= _rows || col >= _cols) {
+      throw std::out_of_range("Index out of the bounds of the LilMatrix");
+    }
+  }
+
+public:
+  /**
+   * @brief Empty matrix of the given size.
+   *
+   * @param rows Number of rows.
+   * @param cols Number of columns.
+   */
+  LilMatrix(std::size_t rows, std::size_t cols)
+      : _rows(rows), _cols(cols), _lists(Store == StorageOrder::row ? rows : cols) {}
+
+  /**
+   * @brief Setter, inserts a zero entry if (row, col) is not stored yet. Thread-safe for
+   * different rows (columns for Store = col).
+   *
+   * @param row Row index.
+   * @param col Column index.
+   * @return T& Entry of the matrix.
+   */
+  T& operator()(std::size_t row, std::size_t col) {
+    _check(row, col);
+    if constexpr (Store == StorageOrder::row) {
+      return _lists[row].at(col);
+    } else {
+      return _lists[col].at(row);
+    }
+  }
+
+  /**
+   * @brief Getter, 0 for entries which are not stored.
+   *
+   * @param row Row index.
+   * @param col Column index.
+   * @return T Value of the entry.
+   */
+  T operator()(std::size_t row, std::size_t col) const {
+    _check(row, col);
+    const auto& list = _lists[Store == StorageOrder::row ? row : col];
+    const std::size_t pos = list.find(Store == StorageOrder::row ? col : row);
+    return pos < list.size() ? list.values()[pos] : T(0);
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t cols() const { return _cols; }
+  std::size_t nnz() const {
+    std::size_t nnz = 0;
+    for (const auto& list : _lists) nnz += list.size();
+    return nnz;
+  }
+
+  /**
+   * @brief Bytes of the rows (inline part included) and of their heap parts, counted as
+   * dynamic storage.
+   */
+  MemoryUsage memory_usage() const {
+    MemoryUsage usage;
+    usage.dynamic = _lists.capacity() * sizeof(SmallRow<T, N>);
+    for (const auto& list : _lists) usage.dynamic += list.heap_bytes();
+    return usage;
+  }
+
+  /**
+   * @brief Frobenius, one or max norm.
+   *
+   * @tparam Norm options are NormOrder::frob, NormOrder::one, NormOrder::max
+   * @return T norm of the matrix
+   */
+  template <NormOrder Norm> T norm() const {
+    if constexpr (Norm == NormOrder::frob) {
+      T res = 0;
+      for (const auto& list : _lists)
+        for (std::size_t p = 0; p < list.size(); ++p) res += list.values()[p] * list.values()[p];
+      return std::sqrt(res);
+    } else {
+      // the sums along the lists, or across them
+      constexpr bool along = (Norm == NormOrder::max) == (Store == StorageOrder::row);
+      std::vector<T> sums(along ? _lists.size() : (Store == StorageOrder::row ? _cols : _rows), 0);
+      for (std::size_t o = 0; o < _lists.size(); ++o)
+        for (std::size_t p = 0; p < _lists[o].size(); ++p)
+          sums[along ? o : _lists[o].indices()[p]] += std::abs(_lists[o].values()[p]);
+      return sums.empty() ? T(0) : *std::max_element(sums.begin(), sums.end());
+    }
+  }
+
+  /**
+   * @brief Matrix-vector product in the uncompressed state, parallel over the rows for Store =
+   * row.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _cols) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    if constexpr (Store == StorageOrder::row) {
+      res.resize(_rows);
+#pragma omp parallel for schedule(static)
+      for (std::size_t i = 0; i < _rows; ++i) {
+        const auto& list = _lists[i];
+        const std::size_t* idx = list.indices();
+        const T* val = list.values();
+        T sum = 0;
+        for (std::size_t p = 0; p < list.size(); ++p) sum += val[p] * vec[idx[p]];
+        res[i] = sum;
+      }
+    } else {
+      res.assign(_rows, 0);
+      for (std::size_t j = 0; j < _cols; ++j) {
+        const auto& list = _lists[j];
+        const std::size_t* idx = list.indices();
+        const T* val = list.values();
+        for (std::size_t p = 0; p < list.size(); ++p) res[idx[p]] += val[p] * vec[j];
+      }
+    }
+  }
+
+  friend std::vector<T> operator*(const LilMatrix& matrix, const std::vector<T>& vec) {
+    std::vector<T> res;
+    matrix.multiply(vec, res);
+    return res;
+  }
+
+  /**
+   * @brief Build the compressed matrix: parallel prefix sum of the row sizes, then a parallel
+   * copy of every (already sorted) row. The lists are left unchanged.
+   *
+   * @return Matrix<T, Store> Compressed matrix with the stored entries.
+   */
+  Matrix<T, Store> compress() const {
+    const std::size_t num_outer = _lists.size();
+    std::vector<std::size_t> inner(num_outer + 1, 0);
+#pragma omp parallel for schedule(static)
+    for (std::size_t o = 0; o < num_outer; ++o) inner[o + 1] = _lists[o].size();
+    _parallel_prefix_sum(inner);
+    if (inner.back() == 0) {
+      throw std::logic_error("Cannot compress an empty matrix");
+    }
+    std::vector<std::size_t> outer(inner.back());
+    std::vector<T> values(inner.back());
+#pragma omp parallel for schedule(static)
+    for (std::size_t o = 0; o < num_outer; ++o) {
+      const auto& list = _lists[o];
+      std::copy(list.indices(), list.indices() + list.size(), outer.begin() + inner[o]);
+      std::copy(list.values(), list.values() + list.size(), values.begin() + inner[o]);
+    }
+    return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values),
+                            Store == StorageOrder::row ? _cols : _rows);
+  }
+};
+#endif
@@ -0,0 +1,62 @@
+#ifndef MATRIX_MEMORY_HPP
+#define MATRIX_MEMORY_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Bytes held by a matrix, split by kind of storage.
+ */
+struct MemoryUsage {
+  // nodes of the mapping of the uncompressed state
+  std::size_t dynamic = 0;
+  // inner/outer/values vectors of the compressed state
+  std::size_t compressed = 0;
+  // derived data kept for the products (row bins, CSC gather index, snapshot
+  // of the mapping)
+  std::size_t caches = 0;
+
+  std::size_t total() const { return dynamic + compressed + caches; }
+};
+
+/**
+ * @brief Estimated heap bytes of one node of a std::map: the red-black tree header (color padded
+ * to a pointer, parent, left and right) and the key/value pair, plus the 8 bytes of the allocator
+ * header, rounded up to the 16 bytes granularity of glibc malloc.
+ */
+template <typename Mapping>
+constexpr std::size_t _map_node_bytes() {
+  constexpr std::size_t request = 4 * sizeof(void*) + sizeof(typename Mapping::value_type);
+  return (request + sizeof(std::size_t) + 15) / 16 * 16;
+}
+
+/**
+ * @brief Heap bytes of a vector, by capacity.
+ */
+template <typename V>
+std::size_t _vector_bytes(const std::vector<V>& vec) {
+  return vec.capacity() * sizeof(V);
+}
+
+/**
+ * @brief Memory held by the matrix. The vectors are counted by capacity, the nodes of the mapping
+ * are estimated with _map_node_bytes, also when the mapping is owned by the user, since the
+ * matrix works on it. The size of the Matrix object itself is not included.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @return MemoryUsage Bytes by kind of storage.
+ */
+template <Numeric T, StorageOrder Store>
+MemoryUsage Matrix<T, Store>::memory_usage() const {
+  MemoryUsage usage;
+  // the snapshot and the gather index may be built by a concurrent const product
+  std::shared_lock snapshot_lock(_snapshot_mutex);
+  std::shared_lock gather_lock(_gather_mutex);
+  usage.dynamic = _entry_value_map.size() * _map_node_bytes<matrix_type>();
+  usage.compressed = _vector_bytes(_inner) + _vector_bytes(_outer) + _vector_bytes(_values);
+  usage.caches = _vector_bytes(_row_perm) + _vector_bytes(_chunk_ptr) + _vector_bytes(_row_chunks) +
+                 _vector_bytes(_gather_inner) + _vector_bytes(_gather_outer) + _vector_bytes(_gather_pos) +
+                 _vector_bytes(_snapshot_inner) + _vector_bytes(_snapshot_outer) + _vector_bytes(_snapshot_values);
+  return usage;
+}
+#endif
@@ -0,0 +1,631 @@
+#ifndef MATRIX_PARTITION_HPP
+#define MATRIX_PARTITION_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Multilevel graph partitioning of the sparsity pattern. The pattern of A + A^T (diagonal removed)
+ * is seen as an undirected graph, which is bisected recursively until k parts are reached. Every
+ * bisection coarsens the graph by heavy-edge matching, grows an initial bisection on the coarsest
+ * graph and refines it with a greedy boundary (Fiduccia-Mattheyses like) pass on each level while
+ * projecting it back to the original graph.
+ */
+
+/**
+ * @brief Undirected weighted graph in a CSR-like format, the neighbours of vertex v are
+ * adjncy[xadj[v]], ..., adjncy[xadj[v + 1] - 1].
+ */
+struct PatternGraph {
+  std::vector<std::size_t> xadj;
+  std::vector<std::size_t> adjncy;
+  std::vector<std::size_t> vwgt;    // vertex weights (number of fine vertices collapsed)
+  std::vector<std::size_t> adjwgt;  // edge weights (number of fine edges collapsed)
+
+  std::size_t size() const { return xadj.empty() ? 0 : xadj.size() - 1; }
+};
+
+/**
+ * @brief Build the permutation which groups the indices by part, keeping the original order inside
+ * each part. Can be passed directly to Matrix::permute.
+ *
+ * @param parts Part of each index, as returned by Matrix::partition.
+ * @param num_parts Number of parts.
+ * @return std::vector<std::size_t> Permutation perm, where perm[new_index] = old_index.
+ */
+inline std::vector<std::size_t> partition_permutation(const std::vector<std::size_t>& parts,
+                                                      std::size_t num_parts) {
+  // counting sort on the part index
+  std::vector<std::size_t> offset(num_parts + 1, 0);
+  for (auto p : parts) ++offset[p + 1];
+  std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+  std::vector<std::size_t> perm(parts.size());
+  for (std::size_t i = 0; i < parts.size(); ++i) perm[offset[parts[i]]++] = i;
+  return perm;
+}
+
+/**
+ * @brief Inverse of a permutation, i.e. inv[perm[i]] = i.
+ *
+ * @param perm Permutation.
+ * @return std::vector<std::size_t> Inverse permutation.
+ */
+inline std::vector<std::size_t> inverse_permutation(const std::vector<std::size_t>& perm) {
+  std::vector<std::size_t> inv(perm.size());
+  for (std::size_t i = 0; i < perm.size(); ++i) inv[perm[i]] = i;
+  return inv;
+}
+
+/**
+ * @brief Apply a permutation to a vector, i.e. y[i] = x[perm[i]]. To go back to the original
+ * ordering use the inverse permutation.
+ *
+ * @tparam T Type of the entries.
+ * @param vec Vector x.
+ * @param perm Permutation, perm[new_index] = old_index.
+ * @return std::vector<T> Permuted vector y.
+ */
+template <Numeric T>
+std::vector<T> permute_vector(const std::vector<T>& vec, const std::vector<std::size_t>& perm) {
+  std::vector<T> res(perm.size());
+  for (std::size_t i = 0; i < perm.size(); ++i) res[i] = vec[perm[i]];
+  return res;
+}
+
+/**
+ * @brief Coarsen the graph by heavy-edge matching: every vertex is matched with the unmatched
+ * neighbour sharing the heaviest edge, matched pairs collapse into one coarse vertex.
+ *
+ * @param graph Fine graph.
+ * @param cmap Output, coarse vertex of each fine vertex.
+ * @param gen Random generator for the visiting order.
+ * @return PatternGraph Coarse graph.
+ */
+inline PatternGraph _coarsen_graph(const PatternGraph& graph, std::vector<std::size_t>& cmap,
+                                   std::mt19937& gen) {
+  constexpr std::size_t unmatched = std::numeric_limits<std::size_t>::max();
+  const std::size_t n = graph.size();
+
+  std::vector<std::size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), gen);
+
+  std::vector<std::size_t> match(n, unmatched);
+  std::vector<std::size_t> representative;
+  cmap.assign(n, 0);
+  for (auto v : order) {
+    if (match[v] != unmatched) continue;
+    std::size_t best = v, best_wgt = 0;
+    for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1]; ++idx) {
+      const std::size_t u = graph.adjncy[idx];
+      if (match[u] == unmatched && graph.adjwgt[idx] > best_wgt) {
+        best = u;
+        best_wgt = graph.adjwgt[idx];
+      }
+    }
+    match[v] = best;
+    match[best] = v;
+    cmap[v] = cmap[best] = representative.size();
+    representative.push_back(v);
+  }
+
+  // merge the edges of the matched pairs, marker holds the position of an already added edge
+  const std::size_t num_coarse = representative.size();
+  PatternGraph coarse;
+  coarse.xadj.assign(num_coarse + 1, 0);
+  coarse.vwgt.assign(num_coarse, 0);
+  std::vector<std::size_t> marker(num_coarse, unmatched);
+  for (std::size_t c = 0; c < num_coarse; ++c) {
+    const std::size_t start = coarse.adjncy.size();
+    const std::size_t v = representative[c];
+    const std::size_t num_members = (match[v] == v) ? 1 : 2;
+    for (std::size_t m = 0; m < num_members; ++m) {
+      const std::size_t u = (m == 0) ? v : match[v];
+      coarse.vwgt[c] += graph.vwgt[u];
+      for (std::size_t idx = graph.xadj[u]; idx < graph.xadj[u + 1]; ++idx) {
+        const std::size_t cw = cmap[graph.adjncy[idx]];
+        if (cw == c) continue;
+        if (marker[cw] != unmatched && marker[cw] >= start) {
+          coarse.adjwgt[marker[cw]] += graph.adjwgt[idx];
+        } else {
+          marker[cw] = coarse.adjncy.size();
+          coarse.adjncy.push_back(cw);
+          coarse.adjwgt.push_back(graph.adjwgt[idx]);
+        }
+      }
+    }
+    coarse.xadj[c + 1] = coarse.adjncy.size();
+  }
+  return coarse;
+}
+
+/**
+ * @brief Gain of moving v to the other side, i.e. external minus internal edge weight.
+ */
+inline long _move_gain(const PatternGraph& graph, const std::vector<std::size_t>& side,
+                       std::size_t v) {
+  long gain = 0;
+  for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1]; ++idx) {
+    const long w = static_cast<long>(graph.adjwgt[idx]);
+    gain += (side[graph.adjncy[idx]] != side[v]) ? w : -w;
+  }
+  return gain;
+}
+
+/**
+ * @brief Whether v has a neighbour on the other side, or no neighbours at all.
+ */
+inline bool _on_boundary(const PatternGraph& graph, const std::vector<std::size_t>& side,
+                         std::size_t v) {
+  for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1]; ++idx)
+    if (side[graph.adjncy[idx]] != side[v]) return true;
+  return graph.xadj[v + 1] == graph.xadj[v];
+}
+
+/**
+ * @brief Greedy boundary refinement of a bisection. Vertices with positive gain are moved as long
+ * as the balance constraint holds, while an overweight side gives away its best vertices.
+ *
+ * @param graph Graph.
+ * @param side Side (0/1) of every vertex, modified in place.
+ * @param max_weight Maximal weight allowed on each side.
+ */
+inline void _refine_bisection(const PatternGraph& graph, std::vector<std::size_t>& side,
+                              const std::array<std::size_t, 2>& max_weight) {
+  constexpr std::size_t max_passes = 8;
+  const std::size_t n = graph.size();
+  std::array<std::size_t, 2> weight{0, 0};
+  for (std::size_t v = 0; v < n; ++v) weight[side[v]] += graph.vwgt[v];
+
+  std::vector<std::pair<long, std::size_t>> candidates;
+  for (std::size_t pass = 0; pass < max_passes; ++pass) {
+    const bool unbalanced = weight[0] > max_weight[0] || weight[1] > max_weight[1];
+    candidates.clear();
+    for (std::size_t v = 0; v < n; ++v) {
+      if (_on_boundary(graph, side, v) || (unbalanced && weight[side[v]] > max_weight[side[v]]))
+        candidates.emplace_back(_move_gain(graph, side, v), v);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::size_t moves = 0;
+    for (const auto& [old_gain, v] : candidates) {
+      const std::size_t from = side[v], to = 1 - from;
+      const long gain = _move_gain(graph, side, v);  // neighbours may have moved meanwhile
+      const bool fits = weight[to] + graph.vwgt[v] <= max_weight[to];
+      const bool overweight = weight[from] > max_weight[from];
+      if ((fits && gain > 0) || (overweight && weight[to] + graph.vwgt[v] < weight[from])) {
+        side[v] = to;
+        weight[from] -= graph.vwgt[v];
+        weight[to] += graph.vwgt[v];
+        ++moves;
+      }
+    }
+    if (moves == 0) break;
+  }
+}
+
+/**
+ * @brief Cut of a bisection, i.e. weight of the edges between the two sides.
+ */
+inline std::size_t _bisection_cut(const PatternGraph& graph, const std::vector<std::size_t>& side) {
+  std::size_t cut = 0;
+  for (std::size_t v = 0; v < graph.size(); ++v)
+    for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1]; ++idx)
+      if (side[graph.adjncy[idx]] != side[v]) cut += graph.adjwgt[idx];
+  return cut / 2;
+}
+
+/**
+ * @brief Initial bisection of the coarsest graph by breadth-first graph growing from a few random
+ * seeds, keeping the refined bisection with the smallest cut.
+ *
+ * @param graph Coarsest graph.
+ * @param max_weight Maximal weight allowed on each side.
+ * @param target0 Target weight of side 0.
+ * @param gen Random generator.
+ * @return std::vector<std::size_t> Side of every vertex.
+ */
+inline std::vector<std::size_t> _grow_bisection(const PatternGraph& graph,
+                                                const std::array<std::size_t, 2>& max_weight,
+                                                std::size_t target0, std::mt19937& gen) {
+  constexpr std::size_t num_tries = 4;
+  const std::size_t n = graph.size();
+  std::uniform_int_distribution<std::size_t> dis(0, n - 1);
+
+  std::vector<std::size_t> best_side;
+  std::size_t best_cut = std::numeric_limits<std::size_t>::max();
+  for (std::size_t attempt = 0; attempt < num_tries; ++attempt) {
+    std::vector<std::size_t> side(n, 1);
+    std::vector<std::size_t> queue;
+    queue.reserve(n);
+    std::size_t weight0 = 0, head = 0, next_seed = dis(gen);
+    while (weight0 < target0) {
+      if (head == queue.size()) {  // new component, pick an unvisited seed
+        while (side[next_seed] == 0) next_seed = (next_seed + 1) % n;
+        side[next_seed] = 0;
+        weight0 += graph.vwgt[next_seed];
+        queue.push_back(next_seed);
+        continue;
+      }
+      const std::size_t v = queue[head++];
+      for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1] && weight0 < target0; ++idx) {
+        const std::size_t u = graph.adjncy[idx];
+        if (side[u] == 1) {
+          side[u] = 0;
+          weight0 += graph.vwgt[u];
+          queue.push_back(u);
+        }
+      }
+    }
+    _refine_bisection(graph, side, max_weight);
+    if (const std::size_t cut = _bisection_cut(graph, side); cut < best_cut) {
+      best_cut = cut;
+      best_side = std::move(side);
+    }
+  }
+  return best_side;
+}
+
+/**
+ * @brief Multilevel bisection: coarsen, bisect the coarsest graph, project back and refine.
+ *
+ * @param graph Graph to bisect.
+ * @param fraction Fraction of the total weight to put on side 0.
+ * @param gen Random generator.
+ * @return std::vector<std::size_t> Side of every vertex.
+ */
+inline std::vector<std::size_t> _multilevel_bisection(const PatternGraph& graph, double fraction,
+                                                      std::mt19937& gen) {
+  constexpr std::size_t coarsest_size = 64;
+  constexpr double imbalance = 0.03;
+
+  std::vector<PatternGraph> levels;
+  std::vector<std::vector<std::size_t>> cmaps;
+  while (true) {
+    const PatternGraph& current = levels.empty() ? graph : levels.back();
+    if (current.size() <= coarsest_size) break;
+    std::vector<std::size_t> cmap;
+    PatternGraph coarse = _coarsen_graph(current, cmap, gen);
+    if (10 * coarse.size() > 9 * current.size()) break;  // matching does not shrink anymore
+    levels.push_back(std::move(coarse));
+    cmaps.push_back(std::move(cmap));
+  }
+
+  const std::size_t total = std::accumulate(graph.vwgt.begin(), graph.vwgt.end(), std::size_t{0});
+  const std::size_t target0 = static_cast<std::size_t>(std::llround(fraction * total));
+  const std::array<std::size_t, 2> target{target0, total - target0};
+  auto max_weight = [&](const PatternGraph& level) {
+    const std::size_t heaviest = *max_element(level.vwgt.begin(), level.vwgt.end());
+    std::array<std::size_t, 2> res;
+    for (std::size_t s = 0; s < 2; ++s)
+      res[s] = target[s] + std::max(heaviest, static_cast<std::size_t>(imbalance * target[s]));
+    return res;
+  };
+
+  const PatternGraph& coarsest = levels.empty() ? graph : levels.back();
+  std::vector<std::size_t> side = _grow_bisection(coarsest, max_weight(coarsest), target0, gen);
+
+  // uncoarsening: project onto the finer level and refine there
+  for (std::size_t l = levels.size(); l-- > 0;) {
+    const PatternGraph& fine = (l == 0) ? graph : levels[l - 1];
+    std::vector<std::size_t> fine_side(fine.size());
+    for (std::size_t v = 0; v < fine.size(); ++v) fine_side[v] = side[cmaps[l][v]];
+    side = std::move(fine_side);
+    _refine_bisection(fine, side, max_weight(fine));
+  }
+  return side;
+}
+
+/**
+ * @brief Subgraph induced by the vertices on one side of a bisection.
+ *
+ * @param graph Graph.
+ * @param side Side of every vertex.
+ * @param which Side to extract.
+ * @param local_to_global Output, vertex of graph corresponding to each subgraph vertex.
+ * @return PatternGraph Induced subgraph.
+ */
+inline PatternGraph _induced_subgraph(const PatternGraph& graph, const std::vector<std::size_t>& side,
+                                      std::size_t which, std::vector<std::size_t>& local_to_global) {
+  constexpr std::size_t absent = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> global_to_local(graph.size(), absent);
+  local_to_global.clear();
+  for (std::size_t v = 0; v < graph.size(); ++v) {
+    if (side[v] == which) {
+      global_to_local[v] = local_to_global.size();
+      local_to_global.push_back(v);
+    }
+  }
+
+  PatternGraph sub;
+  sub.xadj.assign(local_to_global.size() + 1, 0);
+  sub.vwgt.resize(local_to_global.size());
+  for (std::size_t lv = 0; lv < local_to_global.size(); ++lv) {
+    const std::size_t v = local_to_global[lv];
+    sub.vwgt[lv] = graph.vwgt[v];
+    for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1]; ++idx) {
+      if (const std::size_t lu = global_to_local[graph.adjncy[idx]]; lu != absent) {
+        sub.adjncy.push_back(lu);
+        sub.adjwgt.push_back(graph.adjwgt[idx]);
+      }
+    }
+    sub.xadj[lv + 1] = sub.adjncy.size();
+  }
+  return sub;
+}
+
+/**
+ * @brief Recursive bisection into num_parts parts, numbered from first_part on.
+ *
+ * @param graph Graph to partition.
+ * @param global Original vertex of each graph vertex.
+ * @param num_parts Number of parts to create.
+ * @param first_part Index of the first part.
+ * @param parts Output, part of each original vertex.
+ * @param gen Random generator.
+ */
+inline void _recursive_partition(const PatternGraph& graph, const std::vector<std::size_t>& global,
+                                 std::size_t num_parts, std::size_t first_part,
+                                 std::vector<std::size_t>& parts, std::mt19937& gen) {
+  if (num_parts == 1 || graph.size() <= 1) {
+    for (auto v : global) parts[v] = first_part;
+    return;
+  }
+  const std::size_t num_parts0 = num_parts / 2;
+  const auto side = _multilevel_bisection(graph, static_cast<double>(num_parts0) / num_parts, gen);
+
+  std::vector<std::size_t> local_to_global;
+  for (std::size_t s = 0; s < 2; ++s) {
+    const PatternGraph sub = _induced_subgraph(graph, side, s, local_to_global);
+    for (auto& v : local_to_global) v = global[v];
+    _recursive_partition(sub, local_to_global, s == 0 ? num_parts0 : num_parts - num_parts0,
+                         s == 0 ? first_part : first_part + num_parts0, parts, gen);
+  }
+}
+
+/**
+ * @brief Minimum degree ordering on the explicit elimination graph: the vertex of smallest degree
+ * is eliminated first and its neighbours become a clique. Quadratic in the degrees, so it is only
+ * used on the small leaves of the nested dissection.
+ *
+ * @param graph Graph to order.
+ * @param global Original vertex of each graph vertex.
+ * @param order Output, original vertices are appended in elimination order.
+ */
+inline void _minimum_degree(const PatternGraph& graph, const std::vector<std::size_t>& global,
+                            std::vector<std::size_t>& order) {
+  const std::size_t n = graph.size();
+  std::vector<std::vector<std::size_t>> adj(n);
+  for (std::size_t v = 0; v < n; ++v)
+    adj[v].assign(graph.adjncy.begin() + graph.xadj[v], graph.adjncy.begin() + graph.xadj[v + 1]);
+  std::vector<bool> eliminated(n, false);
+  std::vector<std::size_t> merged;
+  for (std::size_t step = 0; step < n; ++step) {
+    std::size_t pivot = n;
+    for (std::size_t v = 0; v < n; ++v)
+      if (!eliminated[v] && (pivot == n || adj[v].size() < adj[pivot].size())) pivot = v;
+    eliminated[pivot] = true;
+    order.push_back(global[pivot]);
+    // the adjacency lists are sorted, merge the neighbours of the pivot into every neighbour
+    for (auto u : adj[pivot]) {
+      merged.clear();
+      std::set_union(adj[u].begin(), adj[u].end(), adj[pivot].begin(), adj[pivot].end(),
+                     std::back_inserter(merged));
+      adj[u].clear();
+      for (auto w : merged)
+        if (w != u && w != pivot) adj[u].push_back(w);
+    }
+    adj[pivot].clear();
+  }
+}
+
+/**
+ * @brief Nested dissection: bisect the graph, turn the smaller boundary of the edge cut into a
+ * vertex separator, order both halves recursively and the separator last. Graphs with at most
+ * leaf_size vertices are ordered by minimum degree.
+ *
+ * @param graph Graph to order.
+ * @param global Original vertex of each graph vertex.
+ * @param leaf_size Size below which the recursion stops.
+ * @param order Output, original vertices are appended in elimination order.
+ * @param gen Random generator.
+ */
+inline void _nested_dissection(const PatternGraph& graph, const std::vector<std::size_t>& global,
+                               std::size_t leaf_size, std::vector<std::size_t>& order, std::mt19937& gen) {
+  const std::size_t n = graph.size();
+  if (n <= leaf_size) {
+    _minimum_degree(graph, global, order);
+    return;
+  }
+  auto side = _multilevel_bisection(graph, 0.5, gen);
+  std::array<std::vector<std::size_t>, 2> boundary;
+  for (std::size_t v = 0; v < n; ++v)
+    for (std::size_t idx = graph.xadj[v]; idx < graph.xadj[v + 1]; ++idx)
+      if (side[graph.adjncy[idx]] != side[v]) {
+        boundary[side[v]].push_back(v);
+        break;
+      }
+  constexpr std::size_t separator = 2;
+  for (auto v : boundary[boundary[0].size() <= boundary[1].size() ? 0 : 1]) side[v] = separator;
+
+  std::array<std::size_t, 3> count{0, 0, 0};
+  for (auto s : side) ++count[s];
+  if (count[0] == 0 || count[1] == 0) {
+    // the bisection failed to split the graph
+    order.insert(order.end(), global.begin(), global.end());
+    return;
+  }
+  std::vector<std::size_t> local_to_global;
+  for (std::size_t s = 0; s < 2; ++s) {
+    const PatternGraph sub = _induced_subgraph(graph, side, s, local_to_global);
+    for (auto& v : local_to_global) v = global[v];
+    _nested_dissection(sub, local_to_global, leaf_size, order, gen);
+  }
+  for (std::size_t v = 0; v < n; ++v)
+    if (side[v] == separator) order.push_back(global[v]);
+}
+
+/**
+ * @brief Build the undirected graph of the pattern of A + A^T, without self loops. Works in both
+ * the compressed and the uncompressed state.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @return PatternGraph Graph with unit vertex and edge weights.
+ */
+template <Numeric T, StorageOrder Store>
+PatternGraph Matrix<T, Store>::_pattern_graph() const {
+  const std::size_t n = std::max(rows(), cols());
+  // the graph is symmetric, so we do not care whether (i, j) is (row, col) or (col, row)
+  auto for_each_entry = [this](auto&& visit) {
+    if (!_is_compressed) {
+      for (const auto& [k, v] : _entry_value_map) visit(k[0], k[1]);
+      return;
+    }
+    for (std::size_t i = 0; i + 1 < _inner.size(); ++i)
+      for (std::size_t idx = _inner[i]; idx < _inner[i + 1]; ++idx) visit(i, _outer[idx]);
+  };
+
+  // count the degrees, fill both directions, then remove the duplicates
+  std::vector<std::size_t> start(n + 1, 0);
+  for_each_entry([&start](std::size_t i, std::size_t j) {
+    if (i != j) {
+      ++start[i + 1];
+      ++start[j + 1];
+    }
+  });
+  std::partial_sum(start.begin(), start.end(), start.begin());
+  std::vector<std::size_t> adj(start[n]);
+  std::vector<std::size_t> pos(start.begin(), start.end() - 1);
+  for_each_entry([&adj, &pos](std::size_t i, std::size_t j) {
+    if (i != j) {
+      adj[pos[i]++] = j;
+      adj[pos[j]++] = i;
+    }
+  });
+
+  PatternGraph graph;
+  graph.xadj.assign(n + 1, 0);
+  graph.vwgt.assign(n, 1);
+  graph.adjncy.reserve(adj.size());
+  for (std::size_t v = 0; v < n; ++v) {
+    auto first = adj.begin() + start[v];
+    auto last = adj.begin() + start[v + 1];
+    std::sort(first, last);
+    graph.adjncy.insert(graph.adjncy.end(), first, std::unique(first, last));
+    graph.xadj[v + 1] = graph.adjncy.size();
+  }
+  graph.adjwgt.assign(graph.adjncy.size(), 1);
+  return graph;
+}
+
+/**
+ * @brief Partition the indices of a (square) matrix into num_parts parts of balanced size
+ * (3% tolerance) with a small edge cut, by multilevel recursive bisection of the pattern graph.
+ * The result is deterministic, since the random generator has a fixed seed.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param num_parts Number of parts.
+ * @return std::vector<std::size_t> Part of every row/column index.
+ */
+template <Numeric T, StorageOrder Store>
+std::vector<std::size_t> Matrix<T, Store>::partition(std::size_t num_parts) const {
+  if (num_parts == 0) {
+    throw std::invalid_argument("The number of parts has to be positive");
+  }
+  const PatternGraph graph = _pattern_graph();
+  std::vector<std::size_t> parts(graph.size(), 0);
+  std::vector<std::size_t> global(graph.size());
+  std::iota(global.begin(), global.end(), 0);
+
+  std::mt19937 gen(42);
+  _recursive_partition(graph, global, num_parts, 0, parts, gen);
+  return parts;
+}
+
+/**
+ * @brief Edge cut of a partition, i.e. number of pairs {i, j} with a_ij or a_ji non-zero and i, j
+ * in different parts. This is the amount of data exchanged in a partitioned SpMV.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param parts Part of every index, of size max(rows(), cols()) as returned by partition.
+ * @return std::size_t Edge cut.
+ */
+template <Numeric T, StorageOrder Store>
+std::size_t Matrix<T, Store>::edge_cut(const std::vector<std::size_t>& parts) const {
+  const PatternGraph graph = _pattern_graph();
+  if (parts.size() != graph.size()) {
+    throw std::invalid_argument("The partition does not match the size of the matrix");
+  }
+  return _bisection_cut(graph, parts);
+}
+
+/**
+ * @brief Symmetric permutation B = P A P^T, i.e. b_ij = a_{perm[i], perm[j]}, so that the parts
+ * of a partition become contiguous blocks. Only available in the compressed state.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param perm Permutation, perm[new_index] = old_index, e.g. from partition_permutation.
+ * @return Matrix<T, Store> Permuted compressed matrix.
+ */
+template <Numeric T, StorageOrder Store>
+Matrix<T, Store> Matrix<T, Store>::permute(const std::vector<std::size_t>& perm) const {
+  if (!_is_compressed) {
+    throw std::logic_error("Permutation is only available in compressed format. Compress first");
+  }
+  if (perm.size() != std::max(rows(), cols())) {
+    throw std::invalid_argument("The permutation does not match the size of the matrix");
+  }
+  // the same in CSR and CSC: the new outer index o takes the entries of perm[o] and every
+  // inner index is renumbered through the inverse permutation
+  const std::size_t n = perm.size();
+  const std::size_t num_outer = _inner.size() - 1;
+  const auto inv = inverse_permutation(perm);
+
+  std::vector<std::size_t> inner(n + 1, 0);
+  std::vector<std::size_t> outer(_outer.size());
+  std::vector<T> values(_values.size());
+  std::vector<std::pair<std::size_t, T>> segment;
+  for (std::size_t o = 0; o < n; ++o) {
+    const std::size_t old = perm[o];
+    segment.clear();
+    if (old < num_outer)
+      for (std::size_t idx = _inner[old]; idx < _inner[old + 1]; ++idx)
+        segment.emplace_back(inv[_outer[idx]], _values[idx]);
+    std::sort(segment.begin(), segment.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (std::size_t s = 0; s < segment.size(); ++s) {
+      outer[inner[o] + s] = segment[s].first;
+      values[inner[o] + s] = segment[s].second;
+    }
+    inner[o + 1] = inner[o] + segment.size();
+  }
+  return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values), n);
+}
+/**
+ * @brief Fill-reducing nested dissection ordering of the pattern of A + A^T for sparse direct
+ * solvers: the parts are eliminated before the separators, so the fill stays inside the parts
+ * and the separator blocks. The result is deterministic, since the random generator has a fixed
+ * seed.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param leaf_size Subgraphs with at most this many vertices are not dissected further.
+ * @return std::vector<std::size_t> Permutation, perm[new_index] = old_index, see permute.
+ */
+template <Numeric T, StorageOrder Store>
+std::vector<std::size_t> Matrix<T, Store>::nested_dissection(std::size_t leaf_size) const {
+  const PatternGraph graph = _pattern_graph();
+  std::vector<std::size_t> global(graph.size());
+  std::iota(global.begin(), global.end(), 0);
+  std::vector<std::size_t> order;
+  order.reserve(graph.size());
+
+  std::mt19937 gen(42);
+  _nested_dissection(graph, global, std::max<std::size_t>(leaf_size, 1), order, gen);
+  return order;
+}
+#endif
@@ -0,0 +1,179 @@
+#ifndef MATRIX_PRODUCTS_HPP
+#define MATRIX_PRODUCTS_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Products of compressed matrices. All the kernels work on the three compressed vectors and are
+ * written for CSR, the CSC case is handled by swapping the operands: the CSC vectors of A are the
+ * CSR vectors of A^T, and (A B)^T = B^T A^T.
+ */
+
+/**
+ * @brief Sparse matrix-matrix product C = A B of two CSR matrices (Gustavson's algorithm), in two
+ * parallel passes: the first counts the distinct columns of every row of C, the second fills the
+ * rows with a dense accumulator and sorts them.
+ *
+ * @tparam T Type of the entries.
+ * @param a_inner, a_outer, a_values CSR vectors of A.
+ * @param b_inner, b_outer, b_values CSR vectors of B.
+ * @param num_cols Number of columns of B.
+ * @param inner, outer, values Output, CSR vectors of C.
+ */
+template <Numeric T>
+void _gustavson_product(const std::vector<std::size_t>& a_inner, const std::vector<std::size_t>& a_outer,
+                        const std::vector<T>& a_values, const std::vector<std::size_t>& b_inner,
+                        const std::vector<std::size_t>& b_outer, const std::vector<T>& b_values,
+                        std::size_t num_cols, std::vector<std::size_t>& inner,
+                        std::vector<std::size_t>& outer, std::vector<T>& values) {
+  constexpr std::size_t unmarked = std::numeric_limits<std::size_t>::max();
+  const std::size_t num_rows = a_inner.empty() ? 0 : a_inner.size() - 1;
+  const std::size_t num_b_rows = b_inner.empty() ? 0 : b_inner.size() - 1;
+
+  // first pass: symbolic product, count the columns of every row
+  inner.assign(num_rows + 1, 0);
+#pragma omp parallel
+  {
+    std::vector<std::size_t> marker(num_cols, unmarked);
+#pragma omp for schedule(dynamic, 64)
+    for (std::size_t i = 0; i < num_rows; ++i) {
+      std::size_t count = 0;
+      for (std::size_t ka = a_inner[i]; ka < a_inner[i + 1]; ++ka) {
+        const std::size_t k = a_outer[ka];
+        if (k >= num_b_rows) continue;
+        for (std::size_t kb = b_inner[k]; kb < b_inner[k + 1]; ++kb) {
+          if (marker[b_outer[kb]] != i) {
+            marker[b_outer[kb]] = i;
+            ++count;
+          }
+        }
+      }
+      inner[i + 1] = count;
+    }
+  }
+  std::partial_sum(inner.begin(), inner.end(), inner.begin());
+
+  // second pass: numeric product
+  outer.resize(inner[num_rows]);
+  values.resize(inner[num_rows]);
+#pragma omp parallel
+  {
+    std::vector<std::size_t> marker(num_cols, unmarked);
+    std::vector<T> accumulator(num_cols, 0);
+#pragma omp for schedule(dynamic, 64)
+    for (std::size_t i = 0; i < num_rows; ++i) {
+      std::size_t pos = inner[i];
+      for (std::size_t ka = a_inner[i]; ka < a_inner[i + 1]; ++ka) {
+        const std::size_t k = a_outer[ka];
+        if (k >= num_b_rows) continue;
+        for (std::size_t kb = b_inner[k]; kb < b_inner[k + 1]; ++kb) {
+          const std::size_t j = b_outer[kb];
+          if (marker[j] != i) {
+            marker[j] = i;
+            outer[pos++] = j;
+            accumulator[j] = 0;
+          }
+          accumulator[j] += a_values[ka] * b_values[kb];
+        }
+      }
+      std::sort(outer.begin() + inner[i], outer.begin() + inner[i + 1]);
+      for (std::size_t idx = inner[i]; idx < inner[i + 1]; ++idx) values[idx] = accumulator[outer[idx]];
+    }
+  }
+}
+
+/**
+ * @brief Transpose of a matrix in the same storage order. The compressed vectors of A in CSR are
+ * those of A^T in CSC, so this is a counting sort of the entries by their inner index.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @return Matrix<T, Store> Compressed A^T.
+ */
+template <Numeric T, StorageOrder Store>
+Matrix<T, Store> Matrix<T, Store>::transpose() const {
+  if (!_is_compressed) {
+    throw std::logic_error("Transpose is only available in compressed format. Compress first");
+  }
+  const std::size_t num_outer = _inner.size() - 1;
+  std::vector<std::size_t> inner(_num_inner + 1, 0);
+  for (auto i : _outer) ++inner[i + 1];
+  std::partial_sum(inner.begin(), inner.end(), inner.begin());
+
+  std::vector<std::size_t> outer(_outer.size());
+  std::vector<T> values(_values.size());
+  std::vector<std::size_t> pos(inner.begin(), inner.end() - 1);
+  for (std::size_t o = 0; o < num_outer; ++o) {
+    for (std::size_t idx = _inner[o]; idx < _inner[o + 1]; ++idx) {
+      const std::size_t p = pos[_outer[idx]]++;
+      outer[p] = o;
+      values[p] = _values[idx];
+    }
+  }
+  return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values), num_outer);
+}
+
+/**
+ * @brief Helper for the matrix-matrix product, see operator*.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param right Right factor B.
+ * @return Matrix<T, Store> Compressed A B.
+ */
+template <Numeric T, StorageOrder Store>
+Matrix<T, Store> Matrix<T, Store>::_multiply_matrix(const Matrix<T, Store>& right) const {
+  if (!_is_compressed || !right._is_compressed) {
+    throw std::logic_error("Matrix-matrix product is only available in compressed format. Compress first");
+  }
+  std::vector<std::size_t> inner, outer;
+  std::vector<T> values;
+  if constexpr (Store == StorageOrder::row) {
+    _gustavson_product(_inner, _outer, _values, right._inner, right._outer, right._values,
+                       right._num_inner, inner, outer, values);
+  } else {
+    // CSC of A B = CSR of B^T A^T
+    _gustavson_product(right._inner, right._outer, right._values, _inner, _outer, _values,
+                       _num_inner, inner, outer, values);
+  }
+  // the inner dimension of A B is the one of B in CSR and the one of A in CSC
+  const std::size_t num_inner = Store == StorageOrder::row ? right._num_inner : _num_inner;
+  return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values), num_inner);
+}
+
+/**
+ * @brief Matrix-vector product y = A x writing into an existing vector, so that iterative
+ * methods do not allocate at every product. Parallel over the rows in the CSR case, with a kernel
+ * for every row length, see row_bins.hpp. Parallel over the columns in the CSC case, or over the
+ * rows in the deterministic mode, see reproducible.hpp.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param vec Vector x.
+ * @param res Output vector y, resized to the number of rows.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+  _count_read();
+  if constexpr (_checked) _check_vector(vec);
+  if (!_is_compressed) {
+    _multiply_snapshot(vec, res);
+    return;
+  }
+  const std::size_t num_outer = _inner.size() - 1;
+  if constexpr (Store == StorageOrder::row) {
+    _multiply_binned(vec, res);
+  } else if (is_deterministic()) {
+    _multiply_ordered(vec, res);
+  } else {
+    // the columns scatter into the same rows, every thread accumulates into its
+    // own copy of the output
+    const std::size_t num_rows = _num_inner;
+    res.assign(num_rows, 0);
+    T* y = res.data();
+#pragma omp parallel for schedule(static) reduction(+ : y[:num_rows])
+    for (std::size_t col_idx = 0; col_idx < num_outer; ++col_idx)
+      for (std::size_t row_idx = _inner[col_idx]; row_idx < _inner[col_idx + 1]; ++row_idx)
+        y[_outer[row_idx]] += _values[row_idx] * vec[col_idx];
+  }
+}
+#endif
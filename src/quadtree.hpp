@@ -0,0 +1,337 @@
+#ifndef MATRIX_QUADTREE_HPP
+#define MATRIX_QUADTREE_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Hierarchical storage for patterns which are dense locally and sparse globally, like the
+ * matrices of adaptively refined meshes. The matrix, padded to a power of two, is split
+ * recursively into quadrants down to square leaves of _leaf_size; empty quadrants are not stored,
+ * and every leaf picks its kernel by density: dense row-major values above the threshold, local
+ * CSR below. The product recurses over the tree with OpenMP tasks, the top and the bottom half of
+ * a node in parallel since they write different parts of y. The matrix-matrix product pairs the
+ * quadrants A_ik B_kj down to the leaves and computes every leaf of the result in parallel.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order of the mapping it is built from.
+ */
+template <Numeric T, StorageOrder Store>
+class QuadTreeMatrix {
+  static constexpr std::size_t _none = std::numeric_limits<std::size_t>::max();
+
+  enum class Kind { inner, dense, sparse };
+
+  /**
+   * @brief Quadrant A(row : row + size, col : col + size). The children are the top-left,
+   * top-right, bottom-left and bottom-right quadrants, _none if empty. A dense leaf has its values
+   * at offset in _dense, a sparse leaf its row pointers at offset in _sparse_ptr.
+   */
+  struct Node {
+    std::size_t row;
+    std::size_t col;
+    std::size_t size;
+    Kind kind;
+    std::array<std::size_t, 4> child;
+    std::size_t offset;
+  };
+
+  struct Entry {
+    std::size_t row;
+    std::size_t col;
+    T value;
+  };
+
+  std::size_t _rows;
+  std::size_t _cols;
+  std::size_t _leaf_size;
+  double _density;
+  std::size_t _nnz = 0;
+  // the root is _nodes[0] unless the matrix is empty
+  std::vector<Node> _nodes;
+  std::vector<T> _dense;
+  std::vector<std::size_t> _sparse_ptr;
+  std::vector<std::uint32_t> _sparse_col;
+  std::vector<T> _sparse_val;
+
+  // rows and columns of the part of a leaf inside the matrix
+  std::size_t _leaf_rows(const Node& leaf) const { return std::min(leaf.size, _rows - leaf.row); }
+  std::size_t _leaf_cols(const Node& leaf) const { return std::min(leaf.size, _cols - leaf.col); }
+
+  /**
+   * @brief Build the tree from entries with the given size, the root covers the smallest power of
+   * two (at least the leaf size) containing the matrix.
+   */
+  QuadTreeMatrix(std::size_t rows, std::size_t cols, std::vector<Entry>& entries,
+                 std::size_t leaf_size, double density)
+      : _rows(rows), _cols(cols), _leaf_size(std::bit_ceil(std::max<std::size_t>(leaf_size, 1))),
+        _density(density), _nnz(entries.size()) {
+    if (density <= 0 || density > 1) {
+      throw std::invalid_argument("The density has to be in (0, 1]");
+    }
+    if (!entries.empty()) {
+      const std::size_t size = std::max(_leaf_size, std::bit_ceil(std::max(_rows, _cols)));
+      _build(entries.begin(), entries.end(), 0, 0, size);
+    }
+  }
+
+  /**
+   * @brief Node of the quadrant with the entries [first, last), which are partitioned in place.
+   */
+  template <typename It>
+  std::size_t _build(It first, It last, std::size_t row, std::size_t col, std::size_t size) {
+    const std::size_t index = _nodes.size();
+    _nodes.push_back({row, col, size, Kind::inner, {_none, _none, _none, _none}, 0});
+    if (size == _leaf_size) {
+      _make_leaf(index, first, last);
+      return index;
+    }
+    const std::size_t half = size / 2;
+    const It bottom = std::partition(first, last, [&](const Entry& e) { return e.row < row + half; });
+    const It top_right = std::partition(first, bottom, [&](const Entry& e) { return e.col < col + half; });
+    const It bottom_right = std::partition(bottom, last, [&](const Entry& e) { return e.col < col + half; });
+    const std::array<It, 5> bounds{first, top_right, bottom, bottom_right, last};
+    for (std::size_t q = 0; q < 4; ++q) {
+      if (bounds[q] == bounds[q + 1]) continue;
+      const std::size_t child = _build(bounds[q], bounds[q + 1], row + (q / 2) * half, col + (q % 2) * half, half);
+      _nodes[index].child[q] = child;
+    }
+    return index;
+  }
+
+  template <typename It>
+  void _make_leaf(std::size_t index, It first, It last) {
+    Node& leaf = _nodes[index];
+    const std::size_t nr = _leaf_rows(leaf), nc = _leaf_cols(leaf);
+    const std::size_t count = last - first;
+    if (static_cast<double>(count) >= _density * static_cast<double>(nr * nc)) {
+      leaf.kind = Kind::dense;
+      leaf.offset = _dense.size();
+      _dense.resize(_dense.size() + nr * nc, 0);
+      for (It e = first; e != last; ++e) _dense[leaf.offset + (e->row - leaf.row) * nc + (e->col - leaf.col)] = e->value;
+      return;
+    }
+    leaf.kind = Kind::sparse;
+    leaf.offset = _sparse_ptr.size();
+    std::sort(first, last, [](const Entry& a, const Entry& b) { return a.row < b.row || (a.row == b.row && a.col < b.col); });
+    It e = first;
+    for (std::size_t i = 0; i < nr; ++i) {
+      _sparse_ptr.push_back(_sparse_val.size());
+      for (; e != last && e->row == leaf.row + i; ++e) {
+        _sparse_col.push_back(static_cast<std::uint32_t>(e->col - leaf.col));
+        _sparse_val.push_back(e->value);
+      }
+    }
+    _sparse_ptr.push_back(_sparse_val.size());
+  }
+
+  /**
+   * @brief y += A x restricted to the quadrant of the node.
+   */
+  void _multiply_node(std::size_t index, const T* x, T* y) const {
+    const Node& node = _nodes[index];
+    if (node.kind == Kind::dense) {
+      const std::size_t nr = _leaf_rows(node), nc = _leaf_cols(node);
+      const T* a = _dense.data() + node.offset;
+      for (std::size_t i = 0; i < nr; ++i) {
+        T sum = 0;
+#pragma omp simd reduction(+ : sum)
+        for (std::size_t j = 0; j < nc; ++j) sum += a[i * nc + j] * x[node.col + j];
+        y[node.row + i] += sum;
+      }
+    } else if (node.kind == Kind::sparse) {
+      const std::size_t nr = _leaf_rows(node);
+      const std::size_t* ptr = _sparse_ptr.data() + node.offset;
+      for (std::size_t i = 0; i < nr; ++i) {
+        T sum = 0;
+        for (std::size_t p = ptr[i]; p < ptr[i + 1]; ++p) sum += _sparse_val[p] * x[node.col + _sparse_col[p]];
+        y[node.row + i] += sum;
+      }
+    } else {
+      // the top half runs as a task, the quadrants of a half write the same rows and stay in order
+      const std::size_t top_left = node.child[0], top_right = node.child[1];
+#pragma omp task if (node.size > 8 * _leaf_size) firstprivate(top_left, top_right)
+      {
+        if (top_left != _none) _multiply_node(top_left, x, y);
+        if (top_right != _none) _multiply_node(top_right, x, y);
+      }
+      if (node.child[2] != _none) _multiply_node(node.child[2], x, y);
+      if (node.child[3] != _none) _multiply_node(node.child[3], x, y);
+#pragma omp taskwait
+    }
+  }
+
+  /**
+   * @brief Pairs (A_ik, B_kj) of leaves contributing to every non-empty leaf of A B, found by
+   * descending both trees together. The smaller tree sits in the top-left corner of the larger
+   * one: above its own size, its root stands for the top-left quadrant and the others are empty.
+   */
+  void _collect_products(const QuadTreeMatrix& right, std::size_t row, std::size_t col, std::size_t size,
+                         std::vector<std::array<std::size_t, 2>> pairs,
+                         std::vector<std::tuple<std::size_t, std::size_t, std::vector<std::array<std::size_t, 2>>>>& jobs) const {
+    if (size == _leaf_size) {
+      jobs.emplace_back(row, col, std::move(pairs));
+      return;
+    }
+    const std::size_t half = size / 2;
+    auto child = [size](const QuadTreeMatrix& tree, std::size_t index, std::size_t q) {
+      const Node& node = tree._nodes[index];
+      if (node.size < size) return q == 0 ? index : _none;
+      return node.child[q];
+    };
+    for (std::size_t i = 0; i < 2; ++i) {
+      for (std::size_t j = 0; j < 2; ++j) {
+        std::vector<std::array<std::size_t, 2>> child_pairs;
+        for (const auto& [a, b] : pairs)
+          for (std::size_t k = 0; k < 2; ++k) {
+            const std::size_t ca = child(*this, a, 2 * i + k), cb = child(right, b, 2 * k + j);
+            if (ca != _none && cb != _none) child_pairs.push_back({ca, cb});
+          }
+        if (!child_pairs.empty())
+          _collect_products(right, row + i * half, col + j * half, half, std::move(child_pairs), jobs);
+      }
+    }
+  }
+
+  /**
+   * @brief acc += A_leaf B_leaf, acc is the dense row-major leaf of the result with num_cols
+   * columns. Row by row of A (Gustavson), the rows of B are dense or sparse.
+   */
+  void _multiply_leaves(const Node& a, const QuadTreeMatrix& right, const Node& b, T* acc,
+                        std::size_t num_cols) const {
+    const std::size_t nr = _leaf_rows(a), nk = _leaf_cols(a), nc = right._leaf_cols(b);
+    auto add_row_of_b = [&](std::size_t i, std::size_t k, T v) {
+      T* c = acc + i * num_cols;
+      if (b.kind == Kind::dense) {
+        const T* row = right._dense.data() + b.offset + k * nc;
+#pragma omp simd
+        for (std::size_t j = 0; j < nc; ++j) c[j] += v * row[j];
+      } else {
+        const std::size_t* ptr = right._sparse_ptr.data() + b.offset;
+        for (std::size_t p = ptr[k]; p < ptr[k + 1]; ++p) c[right._sparse_col[p]] += v * right._sparse_val[p];
+      }
+    };
+    if (a.kind == Kind::dense) {
+      const T* values = _dense.data() + a.offset;
+      for (std::size_t i = 0; i < nr; ++i)
+        for (std::size_t k = 0; k < nk; ++k)
+          if (values[i * nk + k] != 0) add_row_of_b(i, k, values[i * nk + k]);
+    } else {
+      const std::size_t* ptr = _sparse_ptr.data() + a.offset;
+      for (std::size_t i = 0; i < nr; ++i)
+        for (std::size_t p = ptr[i]; p < ptr[i + 1]; ++p) add_row_of_b(i, _sparse_col[p], _sparse_val[p]);
+    }
+  }
+
+public:
+  /**
+   * @brief Build the tree from the mapping of the dynamic storage.
+   *
+   * @param entry_value_map Mapping (row, col) -> value, e.g. the one of an uncompressed Matrix.
+   * @param leaf_size Size of the leaves, rounded up to a power of two.
+   * @param density Minimal fraction of non-zeros of a dense leaf.
+   */
+  explicit QuadTreeMatrix(const typename Matrix<T, Store>::matrix_type& entry_value_map,
+                          std::size_t leaf_size = 64, double density = 0.25)
+      : _rows(0), _cols(0), _leaf_size(leaf_size), _density(density) {
+    std::vector<Entry> entries;
+    entries.reserve(entry_value_map.size());
+    for (const auto& [k, v] : entry_value_map) {
+      entries.push_back({k[0], k[1], v});
+      _rows = std::max(_rows, k[0] + 1);
+      _cols = std::max(_cols, k[1] + 1);
+    }
+    *this = QuadTreeMatrix(_rows, _cols, entries, leaf_size, density);
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t cols() const { return _cols; }
+  // stored entries, explicit zeros of the dense leaves not included
+  std::size_t nnz() const { return _nnz; }
+  std::size_t leaf_size() const { return _leaf_size; }
+  std::size_t num_dense_leaves() const {
+    return std::ranges::count_if(_nodes, [](const Node& node) { return node.kind == Kind::dense; });
+  }
+  std::size_t num_sparse_leaves() const {
+    return std::ranges::count_if(_nodes, [](const Node& node) { return node.kind == Kind::sparse; });
+  }
+
+  /**
+   * @brief Bytes of the nodes and of the leaves, counted as compressed storage.
+   */
+  MemoryUsage memory_usage() const {
+    MemoryUsage usage;
+    usage.compressed = _vector_bytes(_nodes) + _vector_bytes(_dense) + _vector_bytes(_sparse_ptr) +
+                       _vector_bytes(_sparse_col) + _vector_bytes(_sparse_val);
+    return usage;
+  }
+
+  /**
+   * @brief y = A x, recursive over the tree with OpenMP tasks.
+   *
+   * @param vec Vector x of size cols().
+   * @param res Output vector y, resized to rows().
+   */
+  void multiply(const std::vector<T>& vec, std::vector<T>& res) const {
+    if (vec.size() != _cols) {
+      throw std::invalid_argument("The size of the vector does not match the matrix");
+    }
+    res.assign(_rows, 0);
+    if (_nodes.empty()) return;
+    const T* x = vec.data();
+    T* y = res.data();
+#pragma omp parallel
+#pragma omp single
+    _multiply_node(0, x, y);
+  }
+
+  friend std::vector<T> operator*(const QuadTreeMatrix& matrix, const std::vector<T>& vec) {
+    std::vector<T> res;
+    matrix.multiply(vec, res);
+    return res;
+  }
+
+  /**
+   * @brief Matrix-matrix product A B of two trees with the same leaf size, the one with the smaller
+   * padded size is descended as if padded to the larger one. The leaves of the result are
+   * accumulated densely in parallel, then stored dense or sparse by the density of A.
+   *
+   * @param left Left factor A.
+   * @param right Right factor B.
+   * @return QuadTreeMatrix Product A B.
+   */
+  friend QuadTreeMatrix operator*(const QuadTreeMatrix& left, const QuadTreeMatrix& right) {
+    if (left._cols != right._rows) {
+      throw std::invalid_argument("The sizes of the matrices do not match");
+    }
+    const std::size_t left_size = left._nodes.empty() ? 0 : left._nodes[0].size;
+    const std::size_t right_size = right._nodes.empty() ? 0 : right._nodes[0].size;
+    if (left._leaf_size != right._leaf_size) {
+      throw std::invalid_argument("The quadtrees need the same leaf size");
+    }
+    std::vector<std::tuple<std::size_t, std::size_t, std::vector<std::array<std::size_t, 2>>>> jobs;
+    if (left_size > 0 && right_size > 0)
+      left._collect_products(right, 0, 0, std::max(left_size, right_size), {{0, 0}}, jobs);
+
+    std::vector<std::vector<Entry>> leaf_entries(jobs.size());
+#pragma omp parallel
+    {
+      std::vector<T> acc;
+#pragma omp for schedule(dynamic, 1)
+      for (std::size_t l = 0; l < jobs.size(); ++l) {
+        const auto& [row, col, pairs] = jobs[l];
+        const std::size_t nr = std::min(left._leaf_size, left._rows - row);
+        const std::size_t nc = std::min(left._leaf_size, right._cols - col);
+        acc.assign(nr * nc, 0);
+        for (const auto& [a, b] : pairs)
+          left._multiply_leaves(left._nodes[a], right, right._nodes[b], acc.data(), nc);
+        for (std::size_t i = 0; i < nr; ++i)
+          for (std::size_t j = 0; j < nc; ++j)
+            if (acc[i * nc + j] != 0) leaf_entries[l].push_back({row + i, col + j, acc[i * nc + j]});
+      }
+    }
+    std::vector<Entry> entries;
+    for (const auto& leaf : leaf_entries) entries.insert(entries.end(), leaf.begin(), leaf.end());
+    return QuadTreeMatrix(left._rows, right._cols, entries, left._leaf_size, left._density);
+  }
+};
+#endif
@@ -0,0 +1,119 @@
+#ifndef MATRIX_REPRODUCIBLE_HPP
+#define MATRIX_REPRODUCIBLE_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Deterministic mode of the parallel reductions. In the default (fast) mode the reductions are
+ * OpenMP reductions, whose summation order depends on the number of threads. In the
+ * deterministic mode every accumulation is done in an order fixed by the data only, so that the
+ * results are bitwise identical for any number of threads:
+ * - scalar sums (_dot, i.e. CG, GMRES, the eigenvalue estimators) add partial sums over blocks of
+ *   fixed size, in block order;
+ * - the CSC matrix-vector product gathers every row through a cached row-wise index of the
+ *   entries, in increasing column order, which is also the order of the serial product.
+ * The CSR product, the norms and the other kernels of the library accumulate each output in a
+ * single thread in a fixed order and are deterministic in both modes.
+ */
+
+inline bool _deterministic = false;
+
+// number of terms of the fixed blocks of the deterministic sums
+constexpr std::size_t _reduction_block = 4096;
+
+/**
+ * @brief Switch between the fast (default) and the deterministic mode, for all matrices.
+ *
+ * @param on true for the deterministic mode.
+ */
+inline void set_deterministic(bool on) { _deterministic = on; }
+
+inline bool is_deterministic() { return _deterministic; }
+
+/**
+ * @brief Parallel sum of term(i) for i in [0, size), reproducible in the deterministic mode.
+ *
+ * @tparam T Type of the terms.
+ * @param size Number of terms.
+ * @param term Callable returning the i-th term.
+ * @return T Sum of the terms.
+ */
+template <Numeric T, typename Term>
+T _parallel_sum(std::size_t size, Term&& term) {
+  T res = 0;
+  if (!_deterministic) {
+#pragma omp parallel for schedule(static) reduction(+ : res)
+    for (std::size_t i = 0; i < size; ++i) res += term(i);
+    return res;
+  }
+  const std::size_t num_blocks = (size + _reduction_block - 1) / _reduction_block;
+  std::vector<T> partial(num_blocks);
+#pragma omp parallel for schedule(static)
+  for (std::size_t b = 0; b < num_blocks; ++b) {
+    const std::size_t last = std::min(size, (b + 1) * _reduction_block);
+    T sum = 0;
+    for (std::size_t i = b * _reduction_block; i < last; ++i) sum += term(i);
+    partial[b] = sum;
+  }
+  for (const auto& p : partial) res += p;
+  return res;
+}
+
+/**
+ * @brief Row-wise index of the entries of a CSC matrix: the entries of row i are
+ * _gather_outer/_gather_pos[_gather_inner[i], _gather_inner[i + 1]), with their column and their
+ * position in _values, in increasing column order. Built on the first deterministic product, under
+ * an exclusive lock of _gather_mutex, and dropped by uncompress().
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_build_gather_index() const {
+  const std::size_t num_outer = _inner.size() - 1;
+  _gather_inner.assign(_num_inner + 1, 0);
+  for (auto i : _outer) ++_gather_inner[i + 1];
+  std::partial_sum(_gather_inner.begin(), _gather_inner.end(), _gather_inner.begin());
+  _gather_outer.resize(_outer.size());
+  _gather_pos.resize(_outer.size());
+  std::vector<std::size_t> next(_gather_inner.begin(), _gather_inner.end() - 1);
+  for (std::size_t o = 0; o < num_outer; ++o) {
+    for (std::size_t p = _inner[o]; p < _inner[o + 1]; ++p) {
+      const std::size_t q = next[_outer[p]]++;
+      _gather_outer[q] = o;
+      _gather_pos[q] = p;
+    }
+  }
+}
+
+/**
+ * @brief Deterministic CSC matrix-vector product, parallel over the rows. Thread-safe for
+ * concurrent const products: the gather index is read under a shared lock of _gather_mutex and
+ * the first product builds it under an exclusive one.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param vec Vector x.
+ * @param res Output vector y, resized to the number of rows.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_multiply_ordered(const std::vector<T>& vec, std::vector<T>& res) const {
+  std::shared_lock lock(_gather_mutex);
+  if (_gather_inner.empty()) {
+    lock.unlock();
+    {
+      // another thread may have built it in the meantime
+      std::unique_lock build(_gather_mutex);
+      if (_gather_inner.empty()) _build_gather_index();
+    }
+    lock.lock();
+  }
+  res.resize(_num_inner);
+#pragma omp parallel for schedule(static)
+  for (std::size_t i = 0; i < _num_inner; ++i) {
+    T sum = 0;
+    for (std::size_t q = _gather_inner[i]; q < _gather_inner[i + 1]; ++q)
+      sum += _values[_gather_pos[q]] * vec[_gather_outer[q]];
+    res[i] = sum;
+  }
+}
+#endif
@@ -0,0 +1,121 @@
+#ifndef MATRIX_ROW_BINS_HPP
+#define MATRIX_ROW_BINS_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Row-length binning of the CSR matrix-vector product. At compression the rows are sorted into
+ * three bins by their number of non-zeros, keeping the natural order inside a bin, and each bin
+ * gets its own kernel in the same parallel region:
+ * - short rows (at most 4 entries) are unrolled by length, without loop overhead;
+ * - medium rows are SIMD reductions over the gathered entries, distributed dynamically;
+ * - long rows (more than 1024 entries) are split into chunks of 1024 entries, the chunks of all
+ *   long rows are distributed over the threads and their partial sums reduced in a fixed order,
+ *   so that a single long row does not serialize the product.
+ */
+
+// rows with at most this many entries are short, with more than _long_row_length long
+constexpr std::size_t _short_row_length = 4;
+constexpr std::size_t _long_row_length = 1024;
+
+/**
+ * @brief Bin the rows by length and split the long rows into chunks, called whenever a CSR
+ * matrix gets compressed.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_bin_rows() {
+  const std::size_t num_rows = _inner.empty() ? 0 : _inner.size() - 1;
+  auto bin = [this](std::size_t i) -> std::size_t {
+    const std::size_t length = _inner[i + 1] - _inner[i];
+    return length <= _short_row_length ? 0 : (length <= _long_row_length ? 1 : 2);
+  };
+  // counting sort of the rows by bin
+  _bin_ptr.fill(0);
+  for (std::size_t i = 0; i < num_rows; ++i) ++_bin_ptr[bin(i) + 1];
+  std::partial_sum(_bin_ptr.begin(), _bin_ptr.end(), _bin_ptr.begin());
+  _row_perm.resize(num_rows);
+  std::array<std::size_t, 3> pos{_bin_ptr[0], _bin_ptr[1], _bin_ptr[2]};
+  for (std::size_t i = 0; i < num_rows; ++i) _row_perm[pos[bin(i)]++] = i;
+
+  _chunk_ptr.assign(1, 0);
+  _row_chunks.clear();
+  for (std::size_t k = _bin_ptr[2]; k < _bin_ptr[3]; ++k) {
+    const std::size_t i = _row_perm[k];
+    for (std::size_t begin = _inner[i]; begin < _inner[i + 1]; begin += _long_row_length)
+      _row_chunks.push_back({begin, std::min(begin + _long_row_length, _inner[i + 1])});
+    _chunk_ptr.push_back(_row_chunks.size());
+  }
+}
+
+/**
+ * @brief CSR matrix-vector product y = A x with one kernel per bin, see the top of the file.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param vec Vector x.
+ * @param res Output vector y, resized to the number of rows.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_multiply_binned(const std::vector<T>& vec, std::vector<T>& res) const {
+  res.resize(_row_perm.size());
+  std::vector<T> partial(_row_chunks.size());
+  const std::size_t num_long = _bin_ptr[3] - _bin_ptr[2];
+  const T* x = vec.data();
+#pragma omp parallel
+  {
+#pragma omp for schedule(static) nowait
+    for (std::size_t k = _bin_ptr[0]; k < _bin_ptr[1]; ++k) {
+      const std::size_t i = _row_perm[k], p = _inner[i];
+      const std::size_t* c = _outer.data() + p;
+      const T* v = _values.data() + p;
+      switch (_inner[i + 1] - p) {
+        case 0: res[i] = 0; break;
+        case 1: res[i] = v[0] * x[c[0]]; break;
+        case 2: res[i] = v[0] * x[c[0]] + v[1] * x[c[1]]; break;
+        case 3: res[i] = v[0] * x[c[0]] + v[1] * x[c[1]] + v[2] * x[c[2]]; break;
+        default: res[i] = v[0] * x[c[0]] + v[1] * x[c[1]] + v[2] * x[c[2]] + v[3] * x[c[3]];
+      }
+    }
+
+#pragma omp for schedule(dynamic, 64) nowait
+    for (std::size_t k = _bin_ptr[1]; k < _bin_ptr[2]; ++k) {
+      const std::size_t i = _row_perm[k];
+      T sum = 0;
+#pragma omp simd reduction(+ : sum)
+      for (std::size_t p = _inner[i]; p < _inner[i + 1]; ++p) sum += _values[p] * x[_outer[p]];
+      res[i] = sum;
+    }
+
+#pragma omp for schedule(dynamic, 1)
+    for (std::size_t c = 0; c < _row_chunks.size(); ++c) {
+      T sum = 0;
+#pragma omp simd reduction(+ : sum)
+      for (std::size_t p = _row_chunks[c][0]; p < _row_chunks[c][1]; ++p) sum += _values[p] * x[_outer[p]];
+      partial[c] = sum;
+    }
+
+#pragma omp for schedule(static)
+    for (std::size_t k = 0; k < num_long; ++k) {
+      T sum = 0;
+      for (std::size_t c = _chunk_ptr[k]; c < _chunk_ptr[k + 1]; ++c) sum += partial[c];
+      res[_row_perm[_bin_ptr[2] + k]] = sum;
+    }
+  }
+}
+
+/**
+ * @brief Number of rows in the short, medium and long bin of the CSR product.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @return std::array<std::size_t, 3> Sizes of the bins, all zero if not compressed.
+ */
+template <Numeric T, StorageOrder Store>
+std::array<std::size_t, 3> Matrix<T, Store>::row_bin_sizes() const
+  requires(Store == StorageOrder::row)
+{
+  return {_bin_ptr[1] - _bin_ptr[0], _bin_ptr[2] - _bin_ptr[1], _bin_ptr[3] - _bin_ptr[2]};
+}
+#endif
@@ -28,6 +28,7 @@ void Matrix<T, Store>::_compress_row() {
   _values.resize(num_non_zeros);
 
   std::size_t num_non_zero = 0;
+  _num_inner = 0;
 
   // implement using lower and upper bound
   for (std::size_t row = 0; row < num_rows - 1; ++row){
@@ -35,6 +36,7 @@ void Matrix<T, Store>::_compress_row() {
     auto up = _entry_value_map.upper_bound({row, std::numeric_limits<std::size_t>::max()}); 
 
     for (auto it = low; it != up; ++it) {
+      _num_inner = std::max(_num_inner, it->first[1] + 1);
       _outer[num_non_zero] = it->first[1];  // add the column index
       _values[num_non_zero] = it->second;   // add the value
      ++num_non_zero;
@@ -45,6 +47,8 @@ void Matrix<T, Store>::_compress_row() {
   // save memory and set flags
   _is_compressed = true;
   _entry_value_map.clear();
+  _drop_snapshot();
+  _bin_rows();
 }
 
 /**
@@ -70,9 +74,15 @@ void Matrix<T, Storage>::_uncompress_row() {
   }
   // save memory and set flags
   _is_compressed = false;
+  _drop_snapshot();
   _inner.clear();
   _outer.clear();
   _values.clear();
+  _num_inner = 0;
+  _row_perm.clear();
+  _bin_ptr.fill(0);
+  _chunk_ptr.clear();
+  _row_chunks.clear();
 }
 
 /**
@@ -132,17 +142,9 @@ T& Matrix<T, Store>::_find_compressed_element_row(std::size_t row,
  */
 template <Numeric T, StorageOrder Store>
 std::vector<T> Matrix<T, Store>::_matrix_vector_row(std::vector<T> vec) const {
-  // iterate through the rows, then the elements
+  // the rows are visited bin by bin, with a kernel for each row length
   std::vector<T> res;
-  res.resize(_inner.size() - 1, 0);
-
-  for (std::size_t row_idx = 0; row_idx < _inner.size() - 1; ++row_idx) {
-    // get the columns, according to this row
-    for (std::size_t col_idx = _inner[row_idx]; col_idx < _inner[row_idx + 1];
-         ++col_idx) {
-      res[row_idx] += (vec[_outer[col_idx]] * _values[col_idx]);
-    }
-  }
+  _multiply_binned(vec, res);
   return res;
 }
 
@@ -179,7 +181,7 @@ T Matrix<T, Store>::_max_norm_compressed_row() const {
 template <Numeric T, StorageOrder Store>
 T Matrix<T, Store>::_one_norm_compressed_row() const {
 
-  std::size_t num_cols = *max_element(std::begin(_outer), std::end(_outer));
+  std::size_t num_cols = *max_element(std::begin(_outer), std::end(_outer)) + 1;
   std::vector<T> sum_abs_per_col(num_cols, 0);
   for (std::size_t col_idx = 0; col_idx < _outer.size(); ++col_idx) {
     sum_abs_per_col[_outer[col_idx]] += std::abs(_values[col_idx]);
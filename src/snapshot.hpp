@@ -0,0 +1,119 @@
+#ifndef MATRIX_SNAPSHOT_HPP
+#define MATRIX_SNAPSHOT_HPP
+#include "Matrix.hpp"
+// clang-format off
+/**
+ * Snapshot of the mapping for the matrix-vector product in the uncompressed state. The pattern of
+ * the mapping is copied once into flat row-wise arrays together with the number of columns, with
+ * pointers to the values in the nodes of the mapping, so that the product does not have to walk
+ * the tree (twice for a column-major mapping, whose last key does not give the number of rows)
+ * and can run in parallel over the rows, for both storage orders. The nodes of a std::map do not
+ * move, so values written through operator(), or read through a non-const matrix, never make the
+ * snapshot stale; only a new entry does, and it changes the size of the mapping, which triggers
+ * the rebuild. compress() and uncompress() drop it.
+ * The snapshot is only used when the matrix owns its mapping (built from compressed vectors and
+ * uncompressed): a mapping owned by the user can be edited, or have entries erased and inserted,
+ * behind the back of the matrix, so its product walks the mapping on every call as before.
+ * Const products on the same uncompressed matrix can run from several threads: they read the
+ * snapshot under a shared lock of _snapshot_mutex, and the rebuild takes the lock exclusively.
+ * As for any container, a const product concurrent with a write through the non-const operator()
+ * is a data race.
+ */
+
+/**
+ * @brief Copy the pattern of the mapping into _snapshot_inner/_snapshot_outer, and pointers to its
+ * values into _snapshot_values, sorted by row and then by column: count of the entries per row,
+ * then a walk of the mapping which places every entry at the next free position of its row.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_build_snapshot() const {
+  _snapshot_inner.assign(1, 0);
+  _snapshot_cols = 0;
+  for (const auto& [k, v] : _entry_value_map) {
+    if (k[0] + 2 > _snapshot_inner.size()) _snapshot_inner.resize(k[0] + 2, 0);
+    ++_snapshot_inner[k[0] + 1];
+    _snapshot_cols = std::max(_snapshot_cols, k[1] + 1);
+  }
+  std::partial_sum(_snapshot_inner.begin(), _snapshot_inner.end(), _snapshot_inner.begin());
+  _snapshot_outer.resize(_entry_value_map.size());
+  _snapshot_values.resize(_entry_value_map.size());
+  std::vector<std::size_t> next(_snapshot_inner.begin(), _snapshot_inner.end() - 1);
+  for (const auto& [k, v] : _entry_value_map) {
+    const std::size_t p = next[k[0]]++;
+    _snapshot_outer[p] = k[1];
+    _snapshot_values[p] = &v;
+  }
+  _snapshot_size = _entry_value_map.size();
+  _snapshot_valid = true;
+}
+
+/**
+ * @brief Release the memory of the snapshot.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_drop_snapshot() {
+  std::vector<std::size_t>().swap(_snapshot_inner);
+  std::vector<std::size_t>().swap(_snapshot_outer);
+  std::vector<const T*>().swap(_snapshot_values);
+  _snapshot_cols = 0;
+  _snapshot_size = 0;
+  _snapshot_valid = false;
+}
+
+/**
+ * @brief Matrix-vector product in the uncompressed state. On a mapping owned by the matrix it runs
+ * on the snapshot, rebuilt first if out of date, parallel over the rows and thread-safe for
+ * concurrent const products; every row is summed in increasing column order, as the serial
+ * product on the mapping did. On a mapping owned by the user it scatters over the mapping.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param vec Vector x.
+ * @param res Output vector y, resized to the number of rows.
+ */
+template <Numeric T, StorageOrder Store>
+void Matrix<T, Store>::_multiply_snapshot(const std::vector<T>& vec, std::vector<T>& res) const {
+  if (!_owns_mapping()) {
+    res.clear();
+    for (const auto& [k, v] : _entry_value_map) {
+      if (k[1] >= vec.size()) {
+        throw std::invalid_argument("The size of the vector does not match the matrix");
+      }
+      if (k[0] >= res.size()) res.resize(k[0] + 1, 0);
+      res[k[0]] += v * vec[k[1]];
+    }
+    return;
+  }
+  auto is_current = [this]() {
+    return _snapshot_valid && _snapshot_size == _entry_value_map.size();
+  };
+  std::shared_lock lock(_snapshot_mutex);
+  if (!is_current()) {
+    lock.unlock();
+    {
+      // another thread may have rebuilt it in the meantime
+      std::unique_lock rebuild(_snapshot_mutex);
+      if (!is_current()) _build_snapshot();
+    }
+    lock.lock();
+  }
+  if (vec.size() < _snapshot_cols) {
+    throw std::invalid_argument("The size of the vector does not match the matrix");
+  }
+  const std::size_t num_rows = _snapshot_inner.size() - 1;
+  res.resize(num_rows);
+#pragma omp parallel for schedule(static)
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    T sum = 0;
+    for (std::size_t p = _snapshot_inner[i]; p < _snapshot_inner[i + 1]; ++p)
+      sum += *_snapshot_values[p] * vec[_snapshot_outer[p]];
+    res[i] = sum;
+  }
+}
+#endif
@@ -0,0 +1,165 @@
+#ifndef MATRIX_SOLVERS_HPP
+#define MATRIX_SOLVERS_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Euclidean scalar product, parallel reduction (reproducible in the deterministic mode).
+ */
+template <Numeric T>
+T _dot(const std::vector<T>& x, const std::vector<T>& y) {
+  return _parallel_sum<T>(x.size(), [&x, &y](std::size_t i) { return x[i] * y[i]; });
+}
+
+/**
+ * @brief Identity preconditioner z = r, for unpreconditioned iterations.
+ */
+template <Numeric T>
+struct IdentityPreconditioner {
+  void apply(const std::vector<T>& r, std::vector<T>& z) const { z = r; }
+};
+
+/**
+ * @brief Preconditioned conjugate gradient for symmetric positive definite matrices.
+ * The preconditioner is any object with a method apply(r, z) computing z = M^{-1} r, e.g.
+ * BlockDiagonal (block size 1 gives Jacobi) or AMG.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @tparam Preconditioner Type of the preconditioner.
+ * @param matrix Compressed SPD matrix A.
+ * @param rhs Right-hand side b.
+ * @param x Initial guess, overwritten with the solution.
+ * @param precond Preconditioner M.
+ * @param tol Tolerance on the relative residual ||b - A x|| / ||b||.
+ * @param max_iter Maximal number of iterations.
+ * @return std::size_t Number of iterations, max_iter + 1 if not converged.
+ */
+template <Numeric T, StorageOrder Store, typename Preconditioner>
+std::size_t conjugate_gradient(const Matrix<T, Store>& matrix, const std::vector<T>& rhs,
+                               std::vector<T>& x, const Preconditioner& precond, T tol,
+                               std::size_t max_iter) {
+  const std::size_t n = rhs.size();
+  std::vector<T> r(n), z(n), p(n), q(n);
+  matrix.multiply(x, q);
+  for (std::size_t i = 0; i < n; ++i) r[i] = rhs[i] - q[i];
+
+  T rhs_norm = std::sqrt(_dot(rhs, rhs));
+  if (rhs_norm == T(0)) rhs_norm = 1;
+  if (std::sqrt(_dot(r, r)) / rhs_norm < tol) return 0;
+
+  precond.apply(r, z);
+  p = z;
+  T rho = _dot(r, z);
+  for (std::size_t it = 1; it <= max_iter; ++it) {
+    matrix.multiply(p, q);
+    const T alpha = rho / _dot(p, q);
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+    }
+    if (std::sqrt(_dot(r, r)) / rhs_norm < tol) return it;
+
+    precond.apply(r, z);
+    const T rho_new = _dot(r, z);
+    const T beta = rho_new / rho;
+    rho = rho_new;
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) p[i] = z[i] + beta * p[i];
+  }
+  return max_iter + 1;
+}
+
+/**
+ * @brief Restarted GMRES(m) with right preconditioning for general square matrices, so that the
+ * convergence test is on the true residual ||b - A x|| / ||b||. The Arnoldi basis is built with
+ * modified Gram-Schmidt and the least squares problem is updated with Givens rotations.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @tparam Preconditioner Type of the preconditioner, any object with apply(r, z).
+ * @param matrix Compressed square matrix A.
+ * @param rhs Right-hand side b.
+ * @param x Initial guess, overwritten with the solution.
+ * @param precond Preconditioner M.
+ * @param tol Tolerance on the relative residual.
+ * @param max_iter Maximal total number of iterations.
+ * @param restart Dimension m of the Krylov space before a restart.
+ * @return std::size_t Number of iterations, max_iter + 1 if not converged.
+ */
+template <Numeric T, StorageOrder Store, typename Preconditioner>
+std::size_t gmres(const Matrix<T, Store>& matrix, const std::vector<T>& rhs, std::vector<T>& x,
+                  const Preconditioner& precond, T tol, std::size_t max_iter, std::size_t restart = 30) {
+  const std::size_t n = rhs.size();
+  const std::size_t m = std::max<std::size_t>(restart, 1);
+  std::vector<std::vector<T>> basis(m + 1, std::vector<T>(n));
+  std::vector<T> z(n), w(n);
+  // Hessenberg matrix by columns, h[j * (m + 1) + i] = h_ij
+  std::vector<T> h((m + 1) * m), cs(m), sn(m), g(m + 1), y(m);
+
+  T rhs_norm = std::sqrt(_dot(rhs, rhs));
+  if (rhs_norm == T(0)) rhs_norm = 1;
+  std::size_t it = 0;
+  while (true) {
+    matrix.multiply(x, w);
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) basis[0][i] = rhs[i] - w[i];
+    const T beta = std::sqrt(_dot(basis[0], basis[0]));
+    if (beta / rhs_norm < tol) return it;
+    if (it >= max_iter) return max_iter + 1;
+#pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) basis[0][i] /= beta;
+    std::fill(g.begin(), g.end(), T(0));
+    g[0] = beta;
+
+    std::size_t j = 0;
+    while (j < m && it < max_iter) {
+      precond.apply(basis[j], z);
+      matrix.multiply(z, w);
+      T* hj = h.data() + j * (m + 1);
+      for (std::size_t i = 0; i <= j; ++i) {
+        hj[i] = _dot(w, basis[i]);
+#pragma omp parallel for schedule(static)
+        for (std::size_t l = 0; l < n; ++l) w[l] -= hj[i] * basis[i][l];
+      }
+      hj[j + 1] = std::sqrt(_dot(w, w));
+      if (hj[j + 1] != T(0)) {
+#pragma omp parallel for schedule(static)
+        for (std::size_t l = 0; l < n; ++l) basis[j + 1][l] = w[l] / hj[j + 1];
+      }
+      // previous rotations, then the one eliminating h_{j+1, j}
+      for (std::size_t i = 0; i < j; ++i) {
+        const T tmp = cs[i] * hj[i] + sn[i] * hj[i + 1];
+        hj[i + 1] = -sn[i] * hj[i] + cs[i] * hj[i + 1];
+        hj[i] = tmp;
+      }
+      const T denom = std::hypot(hj[j], hj[j + 1]);
+      cs[j] = hj[j] / denom;
+      sn[j] = hj[j + 1] / denom;
+      hj[j] = denom;
+      hj[j + 1] = 0;
+      g[j + 1] = -sn[j] * g[j];
+      g[j] *= cs[j];
+      ++j;
+      ++it;
+      if (std::abs(g[j]) / rhs_norm < tol) break;
+    }
+
+    // x += M^{-1} V y with H y = g
+    for (std::size_t i = j; i-- > 0;) {
+      y[i] = g[i];
+      for (std::size_t l = i + 1; l < j; ++l) y[i] -= h[l * (m + 1) + i] * y[l];
+      y[i] /= h[i * (m + 1) + i];
+    }
+    std::fill(w.begin(), w.end(), T(0));
+    for (std::size_t i = 0; i < j; ++i) {
+#pragma omp parallel for schedule(static)
+      for (std::size_t l = 0; l < n; ++l) w[l] += y[i] * basis[i][l];
+    }
+    precond.apply(w, z);
+#pragma omp parallel for schedule(static)
+    for (std::size_t l = 0; l < n; ++l) x[l] += z[l];
+  }
+}
+#endif
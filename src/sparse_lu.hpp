@@ -0,0 +1,306 @@
+#ifndef MATRIX_SPARSE_LU_HPP
+#define MATRIX_SPARSE_LU_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Sparse direct solver P A Q = L U for square compressed matrices, in three phases:
+ * - the constructor is the symbolic analysis, a fill-reducing nested dissection ordering Q of
+ *   the columns (see Matrix::nested_dissection),
+ * - factorize() is the left-looking Gilbert-Peierls factorization: every column of L and U is a
+ *   sparse triangular solve whose pattern is found by a depth-first search in the graph of L,
+ *   with threshold partial pivoting that prefers the diagonal, so that the row order follows Q
+ *   whenever the pivots are large enough,
+ * - refactorize() reuses the patterns of L and U and the pivot sequence of the last
+ *   factorize() for a matrix with the same pattern and new values: no search and no pivoting,
+ *   only the floating point work.
+ * L is unit lower triangular, both factors are stored by columns indexed by pivot position.
+ *
+ * @tparam T Type of the entries.
+ */
+template <Numeric T>
+class SparseLU {
+  static constexpr std::size_t _none = std::numeric_limits<std::size_t>::max();
+
+  std::size_t _n;
+  std::vector<std::size_t> _q;     // q[k] = column eliminated at step k
+  std::vector<std::size_t> _pinv;  // pinv[row] = pivot position of the row
+  // columns of A in elimination order, with the original row indices
+  std::vector<std::size_t> _a_ptr, _a_idx;
+  std::vector<T> _a_val;
+  // strictly lower part of L, unit diagonal not stored
+  std::vector<std::size_t> _l_ptr, _l_idx;
+  std::vector<T> _l_val;
+  // U, the diagonal is the last entry of every column
+  std::vector<std::size_t> _u_ptr, _u_idx;
+  std::vector<T> _u_val;
+  mutable std::vector<T> _work;
+
+  /**
+   * @brief Copy the columns of A in the order Q into ptr, idx and val, from the CSC vectors in the
+   * col-major case and from the rows of the transpose in the row-major case.
+   */
+  template <StorageOrder Store>
+  void _load(const Matrix<T, Store>& matrix, std::vector<std::size_t>& ptr,
+             std::vector<std::size_t>& idx, std::vector<T>& val) const {
+    if (!matrix.is_compressed() || matrix.rows() != _n || matrix.cols() != _n) {
+      throw std::invalid_argument("The matrix does not match the symbolic analysis");
+    }
+    auto load_columns = [&](auto&& column) {
+      ptr.assign(1, 0);
+      idx.clear();
+      val.clear();
+      for (std::size_t k = 0; k < _n; ++k) {
+        const auto col = column(_q[k]);
+        idx.insert(idx.end(), col.indices.begin(), col.indices.end());
+        val.insert(val.end(), col.values.begin(), col.values.end());
+        ptr.push_back(idx.size());
+      }
+    };
+    if constexpr (Store == StorageOrder::col) {
+      load_columns([&matrix](std::size_t j) { return matrix.col(j); });
+    } else {
+      const auto transposed = matrix.transpose();
+      load_columns([&transposed](std::size_t j) { return transposed.row(j); });
+    }
+  }
+
+  /**
+   * @brief Non-recursive depth-first search in the graph of L from row j, pushing the finished
+   * rows on xi[top...] so that xi[top, n) ends up in topological order.
+   */
+  void _dfs(std::size_t j, std::size_t stamp, std::size_t& top, std::vector<std::size_t>& xi,
+            std::vector<std::size_t>& mark, std::vector<std::size_t>& stack,
+            std::vector<std::size_t>& pstack) const {
+    std::size_t head = 0;
+    stack[0] = j;
+    while (true) {
+      j = stack[head];
+      const std::size_t col = _pinv[j];
+      if (mark[j] != stamp) {
+        mark[j] = stamp;
+        pstack[head] = col == _none ? 0 : _l_ptr[col];
+      }
+      const std::size_t end = col == _none ? 0 : _l_ptr[col + 1];
+      bool done = true;
+      for (std::size_t p = pstack[head]; p < end; ++p) {
+        const std::size_t i = _l_idx[p];
+        if (mark[i] == stamp) continue;
+        pstack[head] = p + 1;
+        stack[++head] = i;
+        done = false;
+        break;
+      }
+      if (!done) continue;
+      xi[--top] = j;
+      if (head == 0) return;
+      --head;
+    }
+  }
+
+  /**
+   * @brief Sort the entries of every column by index.
+   */
+  static void _sort_columns(const std::vector<std::size_t>& ptr, std::vector<std::size_t>& idx,
+                            std::vector<T>& val) {
+    std::vector<std::pair<std::size_t, T>> column;
+    for (std::size_t k = 0; k + 1 < ptr.size(); ++k) {
+      column.clear();
+      for (std::size_t p = ptr[k]; p < ptr[k + 1]; ++p) column.emplace_back(idx[p], val[p]);
+      std::sort(column.begin(), column.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+      for (std::size_t p = ptr[k]; p < ptr[k + 1]; ++p) std::tie(idx[p], val[p]) = column[p - ptr[k]];
+    }
+  }
+
+public:
+  /**
+   * @brief Symbolic analysis: fill-reducing ordering of the columns.
+   *
+   * @tparam Store Storage order.
+   * @param matrix Square compressed matrix.
+   * @param reorder Whether to use the nested dissection ordering, or the natural one.
+   */
+  template <StorageOrder Store>
+  explicit SparseLU(const Matrix<T, Store>& matrix, bool reorder = true) : _n(matrix.rows()) {
+    if (!matrix.is_compressed()) {
+      throw std::logic_error("The sparse LU is only available in compressed format. Compress first");
+    }
+    if (matrix.rows() != matrix.cols()) {
+      throw std::invalid_argument("The sparse LU needs a square matrix");
+    }
+    if (reorder) {
+      _q = matrix.nested_dissection();
+    } else {
+      _q.resize(_n);
+      std::iota(_q.begin(), _q.end(), 0);
+    }
+    _work.resize(_n);
+  }
+
+  bool is_factorized() const { return _u_ptr.size() == _n + 1; }
+
+  /**
+   * @brief Number of non-zeros of L (without the unit diagonal) and U.
+   */
+  std::size_t nnz_factors() const { return _l_idx.size() + _u_idx.size(); }
+
+  /**
+   * @brief Numeric factorization with threshold partial pivoting: the diagonal entry is the pivot
+   * if its magnitude is at least pivot_tol times the largest one in the column. Throws if the
+   * matrix is numerically singular.
+   *
+   * @tparam Store Storage order.
+   * @param matrix The analyzed matrix, or one with the same size.
+   * @param pivot_tol Threshold in (0, 1], 1 is plain partial pivoting.
+   */
+  template <StorageOrder Store>
+  void factorize(const Matrix<T, Store>& matrix, T pivot_tol = 0.1) {
+    _load(matrix, _a_ptr, _a_idx, _a_val);
+    const std::size_t n = _n;
+    _pinv.assign(n, _none);
+    _l_ptr.assign(1, 0);
+    _u_ptr.assign(1, 0);
+    _l_idx.clear();
+    _l_val.clear();
+    _u_idx.clear();
+    _u_val.clear();
+    _l_idx.reserve(2 * _a_idx.size());
+    _l_val.reserve(2 * _a_idx.size());
+    _u_idx.reserve(2 * _a_idx.size());
+    _u_val.reserve(2 * _a_idx.size());
+
+    std::vector<T> x(n, 0);
+    std::vector<std::size_t> xi(n), mark(n, _none), stack(n), pstack(n);
+    for (std::size_t k = 0; k < n; ++k) {
+      // pattern of x = L \ A(:, q[k]) in topological order
+      std::size_t top = n;
+      for (std::size_t p = _a_ptr[k]; p < _a_ptr[k + 1]; ++p)
+        if (mark[_a_idx[p]] != k) _dfs(_a_idx[p], k, top, xi, mark, stack, pstack);
+      for (std::size_t p = _a_ptr[k]; p < _a_ptr[k + 1]; ++p) x[_a_idx[p]] = _a_val[p];
+      for (std::size_t px = top; px < n; ++px) {
+        const std::size_t j = xi[px], col = _pinv[j];
+        if (col == _none) continue;
+        for (std::size_t p = _l_ptr[col]; p < _l_ptr[col + 1]; ++p) x[_l_idx[p]] -= _l_val[p] * x[j];
+      }
+
+      // rows already pivotal go to U, the largest remaining entry is the candidate pivot
+      std::size_t ipiv = _none;
+      T largest = 0;
+      for (std::size_t px = top; px < n; ++px) {
+        const std::size_t i = xi[px];
+        if (_pinv[i] == _none) {
+          if (std::abs(x[i]) > largest) {
+            largest = std::abs(x[i]);
+            ipiv = i;
+          }
+        } else {
+          _u_idx.push_back(_pinv[i]);
+          _u_val.push_back(x[i]);
+        }
+      }
+      if (ipiv == _none) {
+        throw std::runtime_error("The matrix is singular, the LU factorization failed");
+      }
+      if (const std::size_t diag = _q[k]; _pinv[diag] == _none && std::abs(x[diag]) >= pivot_tol * largest)
+        ipiv = diag;
+      const T pivot = x[ipiv];
+      _u_idx.push_back(k);
+      _u_val.push_back(pivot);
+      _pinv[ipiv] = k;
+      for (std::size_t px = top; px < n; ++px) {
+        const std::size_t i = xi[px];
+        if (_pinv[i] == _none) {
+          _l_idx.push_back(i);
+          _l_val.push_back(x[i] / pivot);
+        }
+        x[i] = 0;
+      }
+      _l_ptr.push_back(_l_idx.size());
+      _u_ptr.push_back(_u_idx.size());
+    }
+    // rows of L by pivot position, and sorted columns for refactorize()
+    for (auto& i : _l_idx) i = _pinv[i];
+    _sort_columns(_l_ptr, _l_idx, _l_val);
+    _sort_columns(_u_ptr, _u_idx, _u_val);
+  }
+
+  /**
+   * @brief Numeric factorization reusing the patterns and pivots of the last factorize(), for a
+   * matrix with the same pattern. Throws std::invalid_argument if the pattern differs from the one
+   * of the last factorize(), before anything is changed, and std::runtime_error if a pivot becomes
+   * zero, in which case factorize() has to be called again.
+   *
+   * @tparam Store Storage order.
+   * @param matrix Matrix with the same pattern as the one of the last factorize().
+   */
+  template <StorageOrder Store>
+  void refactorize(const Matrix<T, Store>& matrix) {
+    if (!is_factorized()) {
+      throw std::logic_error("Call factorize() before refactorize()");
+    }
+    // the pattern of the last factorize() is compared before any state is touched
+    std::vector<std::size_t> ptr, idx;
+    std::vector<T> val;
+    _load(matrix, ptr, idx, val);
+    if (ptr != _a_ptr || idx != _a_idx) {
+      throw std::invalid_argument("The pattern of the matrix has changed, call factorize()");
+    }
+    _a_val = std::move(val);
+    // x is indexed by pivot position, the U pattern is sorted so it is a topological order
+    std::vector<T>& x = _work;
+    std::fill(x.begin(), x.end(), T(0));
+    for (std::size_t k = 0; k < _n; ++k) {
+      for (std::size_t p = _a_ptr[k]; p < _a_ptr[k + 1]; ++p) x[_pinv[_a_idx[p]]] = _a_val[p];
+      const std::size_t diag = _u_ptr[k + 1] - 1;
+      for (std::size_t p = _u_ptr[k]; p < diag; ++p) {
+        const std::size_t j = _u_idx[p];
+        const T xj = x[j];
+        _u_val[p] = xj;
+        x[j] = 0;
+        for (std::size_t pl = _l_ptr[j]; pl < _l_ptr[j + 1]; ++pl) x[_l_idx[pl]] -= _l_val[pl] * xj;
+      }
+      const T pivot = x[k];
+      x[k] = 0;
+      if (pivot == T(0)) {
+        throw std::runtime_error("Zero pivot in the refactorization, call factorize()");
+      }
+      _u_val[diag] = pivot;
+      for (std::size_t p = _l_ptr[k]; p < _l_ptr[k + 1]; ++p) {
+        _l_val[p] = x[_l_idx[p]] / pivot;
+        x[_l_idx[p]] = 0;
+      }
+    }
+  }
+
+  /**
+   * @brief Solve A x = b with one forward and one backward substitution by columns.
+   *
+   * @param b Right-hand side.
+   * @param x Output, resized if needed.
+   */
+  void solve(const std::vector<T>& b, std::vector<T>& x) const {
+    if (!is_factorized()) {
+      throw std::logic_error("Factorize the matrix first");
+    }
+    std::vector<T>& y = _work;
+    for (std::size_t i = 0; i < _n; ++i) y[_pinv[i]] = b[i];
+    for (std::size_t j = 0; j < _n; ++j) {
+      const T yj = y[j];
+      for (std::size_t p = _l_ptr[j]; p < _l_ptr[j + 1]; ++p) y[_l_idx[p]] -= _l_val[p] * yj;
+    }
+    for (std::size_t k = _n; k-- > 0;) {
+      const std::size_t diag = _u_ptr[k + 1] - 1;
+      y[k] /= _u_val[diag];
+      const T yk = y[k];
+      for (std::size_t p = _u_ptr[k]; p < diag; ++p) y[_u_idx[p]] -= _u_val[p] * yk;
+    }
+    x.resize(_n);
+    for (std::size_t k = 0; k < _n; ++k) x[_q[k]] = y[k];
+  }
+
+  /**
+   * @brief Same as solve, so that the factorization can be used as preconditioner.
+   */
+  void apply(const std::vector<T>& r, std::vector<T>& z) const { solve(r, z); }
+};
+#endif
@@ -0,0 +1,214 @@
+#ifndef MATRIX_SUBMATRIX_HPP
+#define MATRIX_SUBMATRIX_HPP
+#include "Matrix.hpp"
+// clang-format off
+
+/**
+ * @brief Zero-copy view of a contiguous range of rows of a CSR matrix (or of columns of a CSC
+ * matrix). It only keeps spans into the compressed vectors of the matrix, so it is invalidated by
+ * uncompress() or by the destruction of the matrix.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order of the viewed matrix.
+ */
+template <Numeric T, StorageOrder Store>
+class MatrixSlice {
+  std::span<const std::size_t> _inner;  // last - first + 1 entries, pointing into the full vectors
+  std::span<const std::size_t> _outer;
+  std::span<const T> _values;
+  std::size_t _num_inner;               // #cols of a row slice, #rows of a col slice
+
+public:
+  /**
+   * @brief Construct a new slice, use Matrix::row_slice or Matrix::col_slice instead.
+   *
+   * @param inner Part of the inner vector of the slice, including the closing entry.
+   * @param outer Whole outer vector of the matrix.
+   * @param values Whole values vector of the matrix.
+   * @param num_inner Size of the non-sliced dimension.
+   */
+  MatrixSlice(std::span<const std::size_t> inner, std::span<const std::size_t> outer,
+              std::span<const T> values, std::size_t num_inner)
+      : _inner(inner), _outer(outer), _values(values), _num_inner(num_inner){};
+
+  std::size_t rows() const {
+    return Store == StorageOrder::row ? _inner.size() - 1 : _num_inner;
+  }
+  std::size_t cols() const {
+    return Store == StorageOrder::col ? _inner.size() - 1 : _num_inner;
+  }
+  std::size_t nnz() const { return _inner.back() - _inner.front(); }
+
+  /**
+   * @brief Const getter, the indices are local to the slice.
+   *
+   * @param row Row index.
+   * @param col Column index.
+   * @return T Value of the entry.
+   */
+  T operator()(std::size_t row, std::size_t col) const {
+    const std::size_t o = Store == StorageOrder::row ? row : col;
+    const std::size_t i = Store == StorageOrder::row ? col : row;
+    for (std::size_t idx = _inner[o]; idx < _inner[o + 1]; ++idx) {
+      if (_outer[idx] == i) {
+        return _values[idx];
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Matrix-vector product with the slice.
+   *
+   * @param slice Slice A.
+   * @param vec Vector x, of size cols().
+   * @return std::vector<T> y = A*x, of size rows().
+   */
+  friend std::vector<T> operator*(const MatrixSlice& slice, const std::vector<T>& vec) {
+    std::vector<T> res(slice.rows(), 0);
+    for (std::size_t o = 0; o + 1 < slice._inner.size(); ++o) {
+      for (std::size_t idx = slice._inner[o]; idx < slice._inner[o + 1]; ++idx) {
+        if constexpr (Store == StorageOrder::row) {
+          res[o] += slice._values[idx] * vec[slice._outer[idx]];
+        } else {
+          res[slice._outer[idx]] += slice._values[idx] * vec[o];
+        }
+      }
+    }
+    return res;
+  }
+};
+
+/**
+ * @brief Zero-copy view of the rows first, ..., last - 1 of a row-compressed matrix.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param first First row of the slice.
+ * @param last One past the last row of the slice.
+ * @return MatrixSlice<T, Store> View of the rows.
+ */
+template <Numeric T, StorageOrder Store>
+MatrixSlice<T, Store> Matrix<T, Store>::row_slice(std::size_t first, std::size_t last) const
+  requires(Store == StorageOrder::row)
+{
+  if (!_is_compressed) {
+    throw std::logic_error("Slicing is only available in compressed format. Compress first");
+  }
+  if (first > last || last + 1 > _inner.size()) {
+    throw std::out_of_range("Row range out of bounds");
+  }
+  return MatrixSlice<T, Store>(std::span(_inner).subspan(first, last - first + 1), _outer,
+                               _values, cols());
+}
+
+/**
+ * @brief Zero-copy view of the columns first, ..., last - 1 of a column-compressed matrix.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param first First column of the slice.
+ * @param last One past the last column of the slice.
+ * @return MatrixSlice<T, Store> View of the columns.
+ */
+template <Numeric T, StorageOrder Store>
+MatrixSlice<T, Store> Matrix<T, Store>::col_slice(std::size_t first, std::size_t last) const
+  requires(Store == StorageOrder::col)
+{
+  if (!_is_compressed) {
+    throw std::logic_error("Slicing is only available in compressed format. Compress first");
+  }
+  if (first > last || last + 1 > _inner.size()) {
+    throw std::out_of_range("Column range out of bounds");
+  }
+  return MatrixSlice<T, Store>(std::span(_inner).subspan(first, last - first + 1), _outer,
+                               _values, rows());
+}
+
+/**
+ * @brief Extract the submatrix A(I, J) as a new compressed matrix, with a two-pass algorithm:
+ * the first pass counts the entries of every row (col) of the submatrix, a prefix sum gives the
+ * new inner vector and the second pass copies the entries. Both passes run in parallel over the
+ * rows (cols) of the submatrix. The index sets need not be sorted, but must not contain duplicates.
+ *
+ * @tparam T Type of the entries.
+ * @tparam Store Storage order.
+ * @param row_indices Row indices I, row i of the submatrix is row I[i] of the matrix.
+ * @param col_indices Column indices J, column j of the submatrix is column J[j] of the matrix.
+ * @return Matrix<T, Store> Compressed submatrix.
+ */
+template <Numeric T, StorageOrder Store>
+Matrix<T, Store> Matrix<T, Store>::submatrix(const std::vector<std::size_t>& row_indices,
+                                             const std::vector<std::size_t>& col_indices) const {
+  if (!_is_compressed) {
+    throw std::logic_error("Submatrix extraction is only available in compressed format. Compress first");
+  }
+  constexpr std::size_t absent = std::numeric_limits<std::size_t>::max();
+  // in the col case the role of rows and cols is simply swapped
+  const auto& outer_sel = Store == StorageOrder::row ? row_indices : col_indices;
+  const auto& inner_sel = Store == StorageOrder::row ? col_indices : row_indices;
+  const std::size_t num_outer = _inner.size() - 1;
+  const std::size_t num_sel = outer_sel.size();
+
+  // position of every selected inner index in the submatrix: a contiguous range (the usual
+  // diagonal block) is a shift, otherwise a lookup table up to the largest selected index
+  const bool sorted = std::is_sorted(inner_sel.begin(), inner_sel.end());
+  const bool contiguous = inner_sel.empty() ||
+      (sorted && inner_sel.back() - inner_sel.front() + 1 == inner_sel.size());
+  const std::size_t shift = inner_sel.empty() ? 0 : inner_sel.front();
+  std::vector<std::size_t> inner_map;
+  if (!contiguous) {
+    inner_map.assign(*max_element(inner_sel.begin(), inner_sel.end()) + 1, absent);
+    for (std::size_t k = 0; k < inner_sel.size(); ++k) inner_map[inner_sel[k]] = k;
+  }
+  auto map_index = [&](std::size_t i) {
+    if (contiguous) return (i >= shift && i - shift < inner_sel.size()) ? i - shift : absent;
+    return i < inner_map.size() ? inner_map[i] : absent;
+  };
+  // small blocks are not worth the thread start-up
+  const bool parallel = num_sel > 1024;
+
+  // first pass: count the entries of every selected row (col)
+  std::vector<std::size_t> inner(num_sel + 1, 0);
+#pragma omp parallel for schedule(static) if (parallel)
+  for (std::size_t k = 0; k < num_sel; ++k) {
+    const std::size_t o = outer_sel[k];
+    if (o >= num_outer) continue;
+    std::size_t count = 0;
+    for (std::size_t idx = _inner[o]; idx < _inner[o + 1]; ++idx) {
+      count += (map_index(_outer[idx]) != absent);
+    }
+    inner[k + 1] = count;
+  }
+  std::partial_sum(inner.begin(), inner.end(), inner.begin());
+
+  // second pass: copy the entries, sorting them if the inner index set is not sorted
+  std::vector<std::size_t> outer(inner[num_sel]);
+  std::vector<T> values(inner[num_sel]);
+#pragma omp parallel for schedule(dynamic, 64) if (parallel)
+  for (std::size_t k = 0; k < num_sel; ++k) {
+    const std::size_t o = outer_sel[k];
+    if (o >= num_outer) continue;
+    std::size_t pos = inner[k];
+    for (std::size_t idx = _inner[o]; idx < _inner[o + 1]; ++idx) {
+      if (const std::size_t i = map_index(_outer[idx]); i != absent) {
+        outer[pos] = i;
+        values[pos] = _values[idx];
+        ++pos;
+      }
+    }
+    if (!sorted) {
+      std::vector<std::pair<std::size_t, T>> segment;
+      for (std::size_t idx = inner[k]; idx < inner[k + 1]; ++idx)
+        segment.emplace_back(outer[idx], values[idx]);
+      std::sort(segment.begin(), segment.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+      for (std::size_t s = 0; s < segment.size(); ++s) {
+        outer[inner[k] + s] = segment[s].first;
+        values[inner[k] + s] = segment[s].second;
+      }
+    }
+  }
+  return Matrix<T, Store>(std::move(inner), std::move(outer), std::move(values), inner_sel.size());
+}
+#endif
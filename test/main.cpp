@@ -31,6 +31,56 @@ int main(int argc, char *argv[]) {
   bench.test_multiplication_correctness(file_name_small);
   bench.medium_benchmark_multiplication(1);
   bench.large_benchmark_multiplication(1);
+  // graph partitioning of the pattern
+  bench.benchmark_partitioning(complex_file_name, 8, 100);
+  // block extraction for a block-Jacobi setup
+  bench.benchmark_submatrix(complex_file_name, 300, 64);
+  // traversal through views and iterators
+  bench.benchmark_traversal(complex_file_name, 10);
+  // block-Jacobi preconditioner
+  bench.benchmark_block_jacobi(300, 4, 10);
+  // multicolor Gauss-Seidel smoother
+  bench.benchmark_gauss_seidel(300, 20);
+  // smoothed aggregation AMG against Jacobi-preconditioned CG
+  bench.benchmark_amg({20, 40}, 1e-8);
+  // power iteration and Lanczos against the norms
+  bench.benchmark_eigenvalues(complex_file_name, 300, 1e-4);
+  // Chebyshev polynomial preconditioner against Jacobi-preconditioned CG
+  bench.benchmark_chebyshev(200, {2, 4, 8}, 1e-8);
+  // sparse direct solver against GMRES
+  bench.benchmark_sparse_lu({file_name, complex_file_name}, 60, 1e-8);
+  // supernodal Cholesky against the sparse LU
+  bench.benchmark_cholesky({100, 200});
+  // Kronecker products, assembled and implicit
+  bench.benchmark_kronecker(file_name, 200, 10);
+  // dense blocks stored as dense tiles next to the CSR remainder
+  bench.benchmark_dense_blocks(300, 8, {64, 256, 512}, 20);
+  // CSR product with the rows binned by length
+  bench.benchmark_row_bins(complex_file_name, 200000, {1000, 50000}, 20);
+  // bitwise reproducible results for any number of threads
+  bench.test_deterministic(complex_file_name, 150, 8, 20);
+  // memory footprint of the dynamic and compressed storage
+  bench.benchmark_memory(complex_file_name, {100, 200, 400});
+  // assembly in random order into the hash table
+  bench.benchmark_assembly(300);
+  // row-wise assembly into the list-of-lists storage
+  bench.benchmark_row_lists(300, 10);
+  // uncompressed products on the snapshot of the mapping
+  bench.benchmark_uncompressed_product(complex_file_name, 300, 20);
+  // lazy compression after a run of read-only operations
+  bench.benchmark_auto_compress(200, {0, 1, 4, 16}, 10, 20);
+  // element access with and without the debug checks (make debug / make)
+  bench.benchmark_checks(complex_file_name, 300, 20);
+  // jagged diagonal storage against the other layouts
+  bench.benchmark_jagged_diagonal(complex_file_name, 300, 200000, 1000, 20);
+  // CSR5 tiles with the same number of non-zeros for every thread
+  bench.benchmark_csr5(complex_file_name, 300, 200000, {1000, 50000}, 20);
+  // compressed sparse blocks for A x and A^T x
+  bench.benchmark_csb(complex_file_name, 300, 20);
+  // quadtree of dense and sparse leaves on an adaptively refined pattern
+  bench.benchmark_quadtree(200, 512, 3, 20);
+  // coordinate storage with the segmented-reduction product
+  bench.benchmark_coo(complex_file_name, 300, 200000, 1000, 20);
 
   return 0;
 }
\ No newline at end of file